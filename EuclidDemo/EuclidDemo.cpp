@@ -605,7 +605,7 @@ bool EuclidDemo::processGrowthQueue(int count)
                     if (tnode.tri.numColumns() == 1)
                     {
                         cout << "FOUND:  " << tnode.tri.path << endl << tnode.tri << endl;
-                        m_search.m_paths.push_back(tnode.tri.path);
+                        m_search.m_paths.push_back(tnode.tri.path.str());
                         bGenerateChildren = false;
                     }
                     else
@@ -1389,7 +1389,11 @@ bool EuclidDemo::addTrianglePath(string path)
 	m_userNode.m_fStartTime = t;
 	m_userNode.m_fLifespan = m_settings.TRI_TIME_LIFESPAN;
 	addTriangleUnique(m_userNode);
-	for(char c : path)
+
+	// parse the op prefix; search results end with markers like "!" or "-ctr"
+	TripletPath ops;
+	ops.assign(path);
+	for(char c : ops.ops())
 	{
 		auto parentTriangle = m_userNode.tri;
 		if(!m_userNode.tri.operate(c))
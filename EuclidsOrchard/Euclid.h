@@ -2,13 +2,48 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
 #include <iostream>
+#include <iomanip>
 #include <sstream>
+#include <fstream>
 #include <queue>
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <functional>
 #include <numeric>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define EUCLID_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define EUCLID_TARGET_AVX2
+#else
+#define EUCLID_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
 
 
 #ifndef TRACE
@@ -49,6 +84,20 @@ T dot(const vector<T> &a, const vector<T> &b)
     return std::inner_product(a.begin(), a.end(), b.begin(), (T)0);
 }
 
+// runs f() {reps} times; prints and returns the mean time per run in ms
+template<class F>
+double benchmark(const char *label, int reps, F f)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < reps; ++i) {
+		f();
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	double ms = elapsed.count() / reps;
+	printf("  %-40s %10.3f ms\n", label, ms);
+	return ms;
+}
+
 template<class C>
 int sign(C v) {
 	return (v < 0 ? -1 : (v ? 1 : 0));
@@ -59,6 +108,92 @@ char signchar(C v) {
 	return (v < 0 ? '-' : (v ? '+' : '0'));
 }
 
+template<class C>
+C magnitude(C v) {
+	return (v < 0 ? -v : v);
+}
+
+//
+//	Integer widths
+//	Wide<I>::type holds the product of two I values. Products of three coordinates (determinant(),
+//	the search classifier's planes) are formed in it too, and those are exact while every
+//	coordinate stays below Wide<I>::maxExact, about the cube root of its range. leftOf() checks
+//	its range, and falls back to double and an exact product (leftOfExact()) above it, so it is
+//	exact for every I.
+//	Choose the narrowest I whose maxExact is above the heights being searched.
+//	64-bit values widen to 128 bits where the compiler has __int128; without it, they are
+//	no safer than 32-bit values. Nothing is wider than 128 bits, so __int128 coordinates have
+//	the same maxExact as 64-bit ones; they only add range to run lengths (searchJump()).
+//
+#if defined(__SIZEOF_INT128__)
+#define EUCLID_INT128 1
+typedef __int128 int128;
+
+inline ostream& operator << (ostream &out, int128 v)
+{
+	char buf[41];
+	char *p = buf + sizeof(buf);
+	*--p = 0;
+	unsigned __int128 u = (v < 0) ? -(unsigned __int128)v : (unsigned __int128)v;
+	do {
+		*--p = (char)('0' + (int)(u % 10));
+		u /= 10;
+	} while(u);
+	if(v < 0) *--p = '-';
+	return out << p;
+}
+#endif
+
+template<class I, size_t BYTES = sizeof(I)>
+struct Wide
+{
+	typedef long long type;
+	static const long long maxExact = 1LL << 20;
+};
+
+#ifdef EUCLID_INT128
+template<class I>
+struct Wide<I, 8>
+{
+	typedef int128 type;
+	static const long long maxExact = 1LL << 41;
+};
+
+template<class I>
+struct Wide<I, 16>
+{
+	typedef int128 type;
+	static const long long maxExact = 1LL << 41;
+};
+#endif
+
+//
+//	Runtime instruction set check, cached after the first call.
+//	Kernels built for AVX2 are only entered when this returns true.
+//
+inline bool cpuHasAvx2()
+{
+#ifdef EUCLID_X86
+#ifdef _MSC_VER
+	static const bool has = []() {
+		int info[4];
+		__cpuid(info, 0);
+		if(info[0] < 7) return false;
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		if(!osxsave || (_xgetbv(0) & 6) != 6) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}();
+#else
+	static const bool has = __builtin_cpu_supports("avx2");
+#endif
+	return has;
+#else
+	return false;
+#endif
+}
+
 // Euclid's GCD algorithm
 template<class I>
 I gcd(I m, I n) {
@@ -79,59 +214,162 @@ I gcd(I m, I n) {
 	}
 }
 
-// modified euclid..
-// gcd(x,y,0) == gcd(x,y)
-inline int gcd2(const int *pValues, int numValues) 
+//
+//	Binary (Stein) GCD
+//	Works on magnitudes in an unsigned type, replacing division with shifts and subtraction.
+//	Trailing zeros are counted with a de Bruijn multiply, so everything here is constexpr
+//	and allocation-free. gcd(x,0) == x, gcd(0,0) == 0, and the result is never negative.
+//
+template<class I, size_t BYTES = sizeof(I)>
+struct UnsignedOf
 {
-	vector<int> p(pValues, pValues + numValues);
-	int i1, v1, v2;
+	typedef unsigned long long type;
+};
 
-	bool changes = true;
-	while(changes) 
-	{
-		changes = false;
+#ifdef EUCLID_INT128
+template<class I>
+struct UnsignedOf<I, 16>
+{
+	typedef unsigned __int128 type;
+};
+#endif
 
-		std::sort(p.begin(), p.end());
-		
-		// replace all values with remainder(value, next smallest value)
-		for(int i2 = numValues - 1; i2 > 0;) 
-		{
-			// find all values equal to [i2]
+static constexpr unsigned char DEBRUIJN64_INDEX[64] = {
+	 0,  1,  2, 53,  3,  7, 54, 27,  4, 38, 41,  8, 34, 55, 48, 28,
+	62,  5, 39, 46, 44, 42, 22,  9, 24, 35, 59, 56, 49, 18, 29, 11,
+	63, 52,  6, 26, 37, 40, 33, 47, 61, 45, 43, 21, 23, 58, 17, 10,
+	51, 25, 36, 32, 60, 20, 57, 16, 50, 31, 19, 15, 30, 14, 13, 12 };
 
-			v2 = p[i2];
-			for(i1 = i2 - 1; i1 >= 0 && (v1 = p[i1]) == v2; --i1);
-			if(i1 < 0) 
-			{
-				break;
-			}
+// v must be nonzero
+constexpr int trailingZeros(unsigned long long v)
+{
+	return DEBRUIJN64_INDEX[((v & (0 - v)) * 0x022fdd63cc95386dull) >> 58];
+}
 
-			// replace all v2 with v2%v1
+#ifdef EUCLID_INT128
+constexpr int trailingZeros(unsigned __int128 v)
+{
+	return (unsigned long long)v ? trailingZeros((unsigned long long)v)
+		: 64 + trailingZeros((unsigned long long)(v >> 64));
+}
+#endif
 
-			if(v1 == 0)
-			{
-				break;
-			}
+template<class I>
+constexpr typename UnsignedOf<I>::type unsignedMagnitude(I v)
+{
+	typedef typename UnsignedOf<I>::type U;
+	return v < 0 ? 0 - (U)v : (U)v;
+}
 
-			int newv2 = v2%v1;
-			for(int j = i2; j > i1; --j) 
-			{
-				p[j] = newv2;
-			}
-			changes = true;
-			i2 = i1;
-		}
+template<class I>
+constexpr I gcdBinary(I a, I b)
+{
+	typedef typename UnsignedOf<I>::type U;
+	U u = unsignedMagnitude(a), v = unsignedMagnitude(b);
+	if(!u) return (I)v;
+	if(!v) return (I)u;
+
+	int shift = trailingZeros(u | v);
+	u >>= trailingZeros(u);
+	do {
+		v >>= trailingZeros(v);
+		// min/max rather than a swap, which compiles without an unpredictable branch
+		U lo = u < v ? u : v;
+		v = (u < v ? v : u) - lo;
+		u = lo;
+	} while(v);
+	return (I)(u << shift);
+}
+
+template<class I>
+constexpr I gcdBinary(I a, I b, I c)
+{
+	I g = gcdBinary(a, b);
+	return g == 1 ? g : gcdBinary(g, c);
+}
+
+// gcd of numValues values, stopping early once it reaches 1
+template<class I>
+constexpr I gcdBinary(const I *pValues, int numValues)
+{
+	I g = 0;
+	for(int i = 0; i < numValues && g != 1; ++i) {
+		g = gcdBinary(g, pValues[i]);
 	}
-	return v2;
+	return g;
 }
 
-// brute-force method--for checking only
+// modified euclid..
 // gcd(x,y,0) == gcd(x,y)
-inline int gcd(const int *pValues, int numValues) 
+// formerly sorted a copy of the values and reduced each by the next smallest; now binary GCD
+template<class I>
+I gcd2(const I *pValues, int numValues) 
+{
+	return gcdBinary(pValues, numValues);
+}
+
+#ifdef EUCLID_X86
+//
+//	Trailing zero count of 8 lanes of 32-bit values.
+//	AVX2 has no per-lane count, so the lowest set bit is isolated and converted to float;
+//	its exponent is the count. Zero lanes give a negative count, which shifts to zero.
+//
+EUCLID_TARGET_AVX2
+inline __m256i trailingZerosAvx2(__m256i w)
+{
+	__m256i lowBit = _mm256_and_si256(w, _mm256_sub_epi32(_mm256_setzero_si256(), w));
+	__m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(lowBit)), 23);
+	return _mm256_sub_epi32(_mm256_and_si256(exponent, _mm256_set1_epi32(0xff)), _mm256_set1_epi32(127));
+}
+
+//	binary GCD of 8 lanes of unsigned 32-bit values. A zero lane takes the other operand's value.
+EUCLID_TARGET_AVX2
+inline __m256i gcdLanesAvx2(__m256i u, __m256i v)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i uZero = _mm256_cmpeq_epi32(u, zero);
+	__m256i vZero = _mm256_cmpeq_epi32(v, zero);
+	u = _mm256_blendv_epi8(u, v, uZero);
+	v = _mm256_blendv_epi8(v, u, vZero);
+
+	__m256i shift = trailingZerosAvx2(_mm256_or_si256(u, v));
+	u = _mm256_srlv_epi32(u, trailingZerosAvx2(u));
+	while(!_mm256_testz_si256(v, v)) {
+		// lanes that already reached v == 0 must keep their u
+		__m256i done = _mm256_cmpeq_epi32(v, zero);
+		v = _mm256_srlv_epi32(v, trailingZerosAvx2(v));
+		__m256i lo = _mm256_min_epu32(u, v);
+		v = _mm256_andnot_si256(done, _mm256_sub_epi32(_mm256_max_epu32(u, v), lo));
+		u = _mm256_blendv_epi8(lo, u, done);
+	}
+	return _mm256_sllv_epi32(u, shift);
+}
+
+//
+//	out[i] = gcd(x[i], y[i], z[i]) for int coordinates, 8 triplets per iteration.
+//	Returns the number of triplets done; the caller finishes the tail.
+//
+EUCLID_TARGET_AVX2
+inline size_t gcdTripletsAvx2(const int *x, const int *y, const int *z, size_t n, int *out)
 {
-	int test = ::gcd2(pValues, numValues);
+	size_t i = 0;
+	for(; i + 8 <= n; i += 8) {
+		__m256i X = _mm256_abs_epi32(_mm256_loadu_si256((const __m256i *)(x + i)));
+		__m256i Y = _mm256_abs_epi32(_mm256_loadu_si256((const __m256i *)(y + i)));
+		__m256i Z = _mm256_abs_epi32(_mm256_loadu_si256((const __m256i *)(z + i)));
+		_mm256_storeu_si256((__m256i *)(out + i), gcdLanesAvx2(gcdLanesAvx2(X, Y), Z));
+	}
+	return i;
+}
+#endif
 
+// brute-force method--for checking only
+// gcd(x,y,0) == gcd(x,y)
+template<class I>
+I gcd(const I *pValues, int numValues) 
+{
 	// set k to min positive value
-	int k = pValues[0];
+	I k = pValues[0];
 	for(int i = 1; i < numValues; ++i) {
 		if(!k || (pValues[i] && pValues[i] < k)) {
 			k = pValues[i];
@@ -161,6 +399,15 @@ inline int gcd(const int *pValues, int numValues)
 	return k;
 }
 
+template<class I> class Triplet;
+template<class I> class TripletTriangle;
+
+namespace std
+{
+	template<class I> std::string to_string(const Triplet<I> &tri);
+	template<class I> std::string to_string(const TripletTriangle<I> &tri);
+}
+
 //
 //	Coprime triplet of integers
 //	Coprimality is not strictly enforced, but can be validated using isCoprime()
@@ -207,7 +454,11 @@ public:
 		return vector<float>({ (float)x / sum, (float)y / sum, (float)z / sum });
 	}
 
-	I lengthSq() const { return x*x + y*y + z*z; }
+	typename Wide<I>::type lengthSq() const
+	{
+		typedef typename Wide<I>::type W;
+		return (W)x*x + (W)y*y + (W)z*z;
+	}
 
 	// vector is all zeros
 	bool operator!() const { return !x && !y && !z; }
@@ -217,23 +468,25 @@ public:
 		return Triplet(x - rhs.x, y - rhs.y, z - rhs.z);
 	}
 
-	int dot(const Triplet &rhs) const
+	typename Wide<I>::type dot(const Triplet &rhs) const
 	{
-		return x * rhs.x + y * rhs.y + z * rhs.z;
+		typedef typename Wide<I>::type W;
+		return (W)x * rhs.x + (W)y * rhs.y + (W)z * rhs.z;
 	}
 
 	// returns true if this a coprime triplet, that is, GCD(x,y,z) == 1
 	int isCoprime() const 
 	{
-		ASSERT(::gcd(x, ::gcd(y, z)) == ::gcd(&x, 3), string("non-transitive gcd")+std::to_string(*this));
-		return (::gcd(x, ::gcd(y, z)) == 1);
+		ASSERT(gcdBinary(x, y, z) == ::gcd(magnitude(x), ::gcd(magnitude(y), magnitude(z))), string("binary gcd mismatch")+std::to_string(*this));
+		return (gcdBinary(x, y, z) == 1);
 	}
 
 	bool isPythagoreanTriple() const
 	{
-		int a2 = x*x;
-		int b2 = y*y;
-		int c2 = z*z;
+		typedef typename Wide<I>::type W;
+		W a2 = (W)x*x;
+		W b2 = (W)y*y;
+		W c2 = (W)z*z;
 		return ((a2 + b2 == c2) || (b2 + c2 == a2) || (c2 + a2 == b2));
 	}
 
@@ -244,11 +497,16 @@ public:
 		z += p.z;
 	}
 
-	inline Triplet operator + (const Triplet &b) const 
+	inline Triplet operator + (const Triplet &b) const
 	{
 		return Triplet(x + b.x, y + b.y, z + b.z);
 	}
 
+	inline Triplet operator * (I k) const
+	{
+		return Triplet(k * x, k * y, k * z);
+	}
+
 	inline bool operator == (const Triplet &p) const 
 	{
 		return (x == p.x && y == p.y && z == p.z);
@@ -314,14 +572,162 @@ public:
 //	Note that only the sign is computed. This avoids extra operations
 //	and also reduces the issue of integer overflow.
 //
+//	leftOf() is adaptive. The 2x2 minors of B and C are always exact in Wide<I>::type. Then:
+//	- when the minors are small enough that A dot minors cannot overflow (below 2^29 for 32-bit
+//	  coordinates, 2^61 for 64-bit coordinates with __int128), it is computed in Wide<I>::type
+//	- otherwise A dot minors is evaluated in double, with a forward error bound proportional to
+//	  the sum of the magnitudes of its terms. The bound also covers rounding 64-bit values to double.
+//	- only when the double result lies within the bound, i.e. the points are (nearly) collinear,
+//	  is the whole product formed exactly (leftOfExact()): in the next wider type when it holds
+//	  three coordinates (32-bit I with __int128), otherwise in 32-bit limbs (leftOfLimbs())
+//	Where Wide<I>::type is no wider than I (128-bit I, or 64-bit I without __int128), B and C
+//	coordinates beyond a quarter of its bits would overflow the minors, so leftOf() goes straight
+//	to leftOfExact() for them.
+//
+
+//	sign of the triple product, computed in W
+template<class W, class I>
+int leftOfIn(const Triplet<I> &a, const Triplet<I> &b, const Triplet<I> &c) 
+{
+	int abm = sign(c.sum()) * sign(a.sum()) * sign(b.sum());
+	return abm * sign(
+		  a.x * ((W)b.y*c.z - (W)b.z*c.y)
+		+ a.y * ((W)b.z*c.x - (W)b.x*c.z)
+		+ a.z * ((W)b.x*c.y - (W)b.y*c.x));
+}
+
+//	magnitude of v in 32-bit limbs, least significant first. returns the sign of v
+template<class I>
+int toLimbs(I v, unsigned int limbs[4])
+{
+	const int n = (int)(sizeof(I) + 3) / 4;
+	const int s = sign(v);
+	for(int i = 0; i < n; ++i) {
+		limbs[i] = (unsigned int)(v & (I)0xffffffff);
+		if(i + 1 < n) v = v >> 16 >> 16;
+	}
+	if(s >= 0) return s;
+
+	// two's complement to magnitude, which also holds the most negative value
+	unsigned long long carry = 1;
+	for(int i = 0; i < n; ++i) {
+		carry += (unsigned int)~limbs[i];
+		limbs[i] = (unsigned int)carry;
+		carry >>= 32;
+	}
+	return -1;
+}
+
+//	sign of the triple product in 32-bit limbs, exact for any I up to 128 bits. Each of its six
+//	terms is multiplied out in full and summed in two's complement.
+template<class I>
+int leftOfLimbs(const Triplet<I> &a, const Triplet<I> &b, const Triplet<I> &c)
+{
+	const int n = (int)(sizeof(I) + 3) / 4, SUM_LIMBS = 13;
+	unsigned int limbs[3][3][4];
+	int signs[3][3];
+	const Triplet<I> *rows[3] = { &a, &b, &c };
+	for(int r = 0; r < 3; ++r) {
+		signs[r][0] = toLimbs(rows[r]->x, limbs[r][0]);
+		signs[r][1] = toLimbs(rows[r]->y, limbs[r][1]);
+		signs[r][2] = toLimbs(rows[r]->z, limbs[r][2]);
+	}
+
+	// a[i] * b[j] * c[k] for the even then the odd permutations (i, j, k)
+	static const int terms[6][3] = { {0,1,2}, {1,2,0}, {2,0,1}, {0,2,1}, {1,0,2}, {2,1,0} };
+	unsigned int sum[SUM_LIMBS] = {};
+	for(int t = 0; t < 6; ++t) {
+		const int i = terms[t][0], j = terms[t][1], k = terms[t][2];
+		int s = signs[0][i] * signs[1][j] * signs[2][k] * (t < 3 ? 1 : -1);
+		if(!s) continue;
+
+		unsigned int ab[8] = {}, abc[12] = {};
+		for(int u = 0; u < n; ++u) {
+			unsigned long long carry = 0;
+			for(int v = 0; v < n; ++v) {
+				carry += (unsigned long long)limbs[0][i][u] * limbs[1][j][v] + ab[u + v];
+				ab[u + v] = (unsigned int)carry;
+				carry >>= 32;
+			}
+			ab[u + n] = (unsigned int)carry;
+		}
+		for(int u = 0; u < 2 * n; ++u) {
+			unsigned long long carry = 0;
+			for(int v = 0; v < n; ++v) {
+				carry += (unsigned long long)ab[u] * limbs[2][k][v] + abc[u + v];
+				abc[u + v] = (unsigned int)carry;
+				carry >>= 32;
+			}
+			abc[u + n] = (unsigned int)carry;
+		}
+
+		// sum += abc, or sum += ~abc + 1
+		unsigned long long carry = (s < 0) ? 1 : 0;
+		for(int u = 0; u < SUM_LIMBS; ++u) {
+			unsigned int term = (u < 3 * n) ? abc[u] : 0;
+			carry += (unsigned long long)sum[u] + (s < 0 ? (unsigned int)~term : term);
+			sum[u] = (unsigned int)carry;
+			carry >>= 32;
+		}
+	}
+
+	int abm = sign(c.sum()) * sign(a.sum()) * sign(b.sum());
+	if(sum[SUM_LIMBS - 1] & 0x80000000) return -abm;
+	for(int u = 0; u < SUM_LIMBS; ++u) {
+		if(sum[u]) return abm;
+	}
+	return 0;
+}
+
+//	exact sign of the triple product, for any I
+template<class I>
+int leftOfExact(const Triplet<I> &a, const Triplet<I> &b, const Triplet<I> &c) 
+{
+	typedef typename Wide<typename Wide<I>::type>::type WW;
+	if(sizeof(WW) >= 3 * sizeof(I)) {
+		return leftOfIn<WW>(a, b, c);
+	}
+	return leftOfLimbs(a, b, c);
+}
+
+static const double LEFTOF_ERROR_BOUND = 8 * DBL_EPSILON;
+
 template<class I>
 int leftOf(const Triplet<I> &a, const Triplet<I> &b, const Triplet<I> &c) 
 {
+	typedef typename Wide<I>::type W;
+
+	// the minors are only exact while b and c stay below 2^(bits of W / 4 - 1) when W is no wider than I
+	if(sizeof(W) < 2 * sizeof(I)) {
+		const I bound = (I)1 << (4 * (int)sizeof(W) - 2);
+		if((magnitude(b.x) >= bound) | (magnitude(b.y) >= bound) | (magnitude(b.z) >= bound)
+			| (magnitude(c.x) >= bound) | (magnitude(c.y) >= bound) | (magnitude(c.z) >= bound)) {
+			return leftOfExact(a, b, c);
+		}
+	}
+
+	W m0 = (W)b.y*c.z - (W)b.z*c.y;
+	W m1 = (W)b.z*c.x - (W)b.x*c.z;
+	W m2 = (W)b.x*c.y - (W)b.y*c.x;
 	int abm = sign(c.sum()) * sign(a.sum()) * sign(b.sum());
-	return abm * sign(
-		  a.x * (b.y*c.z - b.z*c.y)
-		+ a.y * (b.z*c.x - b.x*c.z)
-		+ a.z * (b.x*c.y - b.y*c.x));
+
+	// |a| < 2^(bits of I - 1), so |a| * |m| * 3 fits W while |m| < 2^limBits
+	const int limBits = 8 * (int)(sizeof(W) - sizeof(I)) - 3;
+	if(limBits > 0) {
+		const W lim = (W)1 << (limBits > 0 ? limBits : 0);
+		if((magnitude(m0) < lim) & (magnitude(m1) < lim) & (magnitude(m2) < lim)) {
+			return abm * sign(a.x * m0 + a.y * m1 + a.z * m2);
+		}
+	}
+
+	double t0 = (double)a.x * (double)m0;
+	double t1 = (double)a.y * (double)m1;
+	double t2 = (double)a.z * (double)m2;
+	double det = t0 + t1 + t2;
+	if(magnitude(det) > LEFTOF_ERROR_BOUND * (magnitude(t0) + magnitude(t1) + magnitude(t2))) {
+		return abm * (det > 0 ? 1 : -1);
+	}
+	return leftOfExact(a, b, c);
 }
 
 template<class I>
@@ -341,7 +747,8 @@ istream& operator >> (istream &in, Triplet<I> &p)
 
 namespace std
 {
-    std::string to_string(const Triplet<int> &tri)
+    template<class I>
+    std::string to_string(const Triplet<I> &tri)
     {
         std::ostringstream strstr;
         strstr << tri;
@@ -361,6 +768,7 @@ union SexClass
 	char asChar[4];
 	int asInt = 0;
 
+	constexpr SexClass() { };
 	constexpr SexClass(int i) : asInt(i) { };
 	constexpr SexClass(const char sz[4]) : asInt(*((const int*)(&sz[0]))) { };
 	bool operator==(int i) const { return (asInt == i); }
@@ -385,1444 +793,6376 @@ union SexClass
 #define SEXXP *((const int*)("--+"))
 #define SEX00 *((const int*)("000"))
 
+#ifdef EUCLID_X86
+//
+//	AVX2 kernel for TripletTriangle::PointClassifier's batch methods.
+//	For each point p = (x[i], y[i], z[i]), writes SexClass codes whose chars are
+//	signchar(sign(p.sum()) * sign(p . planes[k])), k = 0..2, four points per iteration.
+//	Products are formed 32x32->64 bits, so planes must be below 2^31 and coordinates below 2^29;
+//	returns at the first group of 4 that has a larger coordinate, or when fewer than 4 remain.
+//	Returns the number of points classified.
+//
+EUCLID_TARGET_AVX2
+inline size_t classifyPlanesAvx2(const long long planes[3][3],
+	const int *x, const int *y, const int *z, size_t n, SexClass *out)
+{
+	__m256i px[3], py[3], pz[3];
+	for(int k = 0; k < 3; ++k) {
+		px[k] = _mm256_set1_epi64x(planes[k][0]);
+		py[k] = _mm256_set1_epi64x(planes[k][1]);
+		pz[k] = _mm256_set1_epi64x(planes[k][2]);
+	}
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i charZero = _mm256_set1_epi64x('0');
+	const __m256i toPlus = _mm256_set1_epi64x('+' - '0');
+	const __m256i toMinus = _mm256_set1_epi64x('-' - '0');
+	const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		__m128i x4 = _mm_loadu_si128((const __m128i *)(x + i));
+		__m128i y4 = _mm_loadu_si128((const __m128i *)(y + i));
+		__m128i z4 = _mm_loadu_si128((const __m128i *)(z + i));
+		__m128i mag = _mm_or_si128(_mm_abs_epi32(x4), _mm_or_si128(_mm_abs_epi32(y4), _mm_abs_epi32(z4)));
+		if(!_mm_testz_si128(_mm_srli_epi32(mag, 29), _mm_set1_epi32(-1))) break;
+
+		__m256i X = _mm256_cvtepi32_epi64(x4);
+		__m256i Y = _mm256_cvtepi32_epi64(y4);
+		__m256i Z = _mm256_cvtepi32_epi64(z4);
+		__m256i sum = _mm256_add_epi64(X, _mm256_add_epi64(Y, Z));
+		__m256i flip = _mm256_cmpgt_epi64(zero, sum);		// negate where the sum is negative
+		__m256i keep = _mm256_xor_si256(_mm256_cmpeq_epi64(sum, zero), _mm256_set1_epi64x(-1));
+
+		__m256i codes = zero;
+		for(int k = 0; k < 3; ++k) {
+			__m256i d = _mm256_add_epi64(_mm256_mul_epi32(X, px[k]),
+				_mm256_add_epi64(_mm256_mul_epi32(Y, py[k]), _mm256_mul_epi32(Z, pz[k])));
+			d = _mm256_sub_epi64(_mm256_xor_si256(d, flip), flip);
+			__m256i pos = _mm256_and_si256(_mm256_cmpgt_epi64(d, zero), keep);
+			__m256i neg = _mm256_and_si256(_mm256_cmpgt_epi64(zero, d), keep);
+			__m256i c = _mm256_add_epi64(charZero,
+				_mm256_add_epi64(_mm256_and_si256(pos, toPlus), _mm256_and_si256(neg, toMinus)));
+			codes = _mm256_or_si256(codes, _mm256_slli_epi64(c, 8 * k));
+		}
+		codes = _mm256_permutevar8x32_epi32(codes, lowHalves);
+		_mm_storeu_si128((__m128i *)(out + i), _mm256_castsi256_si128(codes));
+	}
+	return i;
+}
+#endif
+
 
 
 template<class I>
 char Triplet<I>::_buf[] = "***";
 
 //
-//	3x3 integer matrix
+//	Open-addressing hash set of triplets
+//	Used to dedup enumeration results. Slots hold the triplets themselves, probed linearly,
+//	so a lookup touches one or two cache lines instead of walking a tree.
+//	The zero triplet marks an empty slot; it is tracked by a separate flag.
 //
 template<class I>
-class TripletTriangle 
+class TripletHashSet
 {
 public:
-	Triplet<I> m[3] = { { 1,0,0 },{ 0,1,0 },{ 0,0,1 } };
-public:
-	string path = "";
-	unsigned int depth = 0;
+	TripletHashSet()
+		: m_size(0), m_mask(0), m_hasZero(false) {}
 
-	TripletTriangle() {}
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
 
-	TripletTriangle(const Triplet<I> &p0, const Triplet<I> &p1, const Triplet<I> &p2) 
+	// releases the table
+	void clear()
 	{
-		m[0] = p0;
-		m[1] = p1;
-		m[2] = p2;
+		vector<Triplet<I>>().swap(m_slots);
+		m_size = 0;
+		m_mask = 0;
+		m_hasZero = false;
 	}
 
-	TripletTriangle(char op, const TripletTriangle<I> &src) 
+	void reserve(size_t n)
 	{
-		operate(op, src);
+		size_t capacity = 16;
+		while(capacity < 2 * n) capacity *= 2;
+		if(capacity > m_slots.size()) rehash(capacity);
 	}
 
-	bool isZero() const
+	// inserts p if absent, in a single probe sequence. returns true if p was new
+	bool insert(const Triplet<I> &p)
 	{
-		return (!m[0] && !m[1] && !m[2]);
-	}
+		if(isEmptySlot(p)) {
+			if(m_hasZero) return false;
+			m_hasZero = true;
+			++m_size;
+			return true;
+		}
 
-	TripletTriangle operator+(char op) const
-	{
-		TripletTriangle result(*this);
-        result.operate(op);
-		return result;
-	}
+		// keep the load factor at or below 1/2
+		if(2 * (m_size + 1) > m_slots.size()) {
+			rehash(m_slots.empty() ? 16 : 2 * m_slots.size());
+		}
 
-	//	Reset to identity matrix/basis triangle
-	void reset() 
-	{
-		m[0].set(1, 0, 0);
-		m[1].set(0, 1, 0);
-		m[2].set(0, 0, 1);
-		depth = 0;
+		for(size_t i = hash(p) & m_mask; ; i = (i + 1) & m_mask) {
+			Triplet<I> &slot = m_slots[i];
+			if(isEmptySlot(slot)) {
+				slot = p;
+				++m_size;
+				return true;
+			}
+			if(slot == p) return false;
+		}
 	}
 
-	void set(const Triplet<I> &p0, const Triplet<I> &p1, const Triplet<I> &p2) 
+	bool contains(const Triplet<I> &p) const
 	{
-		m[0] = p0;
-		m[1] = p1;
-		m[2] = p2;
+		if(isEmptySlot(p)) return m_hasZero;
+		if(m_slots.empty()) return false;
+
+		for(size_t i = hash(p) & m_mask; ; i = (i + 1) & m_mask) {
+			const Triplet<I> &slot = m_slots[i];
+			if(isEmptySlot(slot)) return false;
+			if(slot == p) return true;
+		}
 	}
 
-	int numColumns() const
+	// mixes all three coordinates, then applies the murmur3 finalizer so that
+	// nearby triplets spread over the whole table
+	static size_t hash(const Triplet<I> &p)
 	{
-		return !!m[0] + !!m[1] + !!m[2];
+		unsigned long long h = (unsigned long long)p.x;
+		h = h * 0x9e3779b97f4a7c15ull + (unsigned long long)p.y;
+		h = h * 0x9e3779b97f4a7c15ull + (unsigned long long)p.z;
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return (size_t)h;
 	}
 
-	// fetch column / triplet
-	const Triplet<I>& operator [](int idx) const 
+private:
+	vector<Triplet<I>> m_slots;
+	size_t m_size;
+	size_t m_mask;
+	bool m_hasZero;
+
+	static bool isEmptySlot(const Triplet<I> &p)
 	{
-		assert(idx >= 0 && idx < 3);
-		return m[idx];
+		return !p.x && !p.y && !p.z;
 	}
 
-	// fetch column / triplet
-	Triplet<I>& operator [](int idx) 
+	void rehash(size_t capacity)
 	{
-		assert(idx >= 0 && idx < 3);
-		return m[idx];
+		vector<Triplet<I>> slots(capacity, Triplet<I>(0, 0, 0));
+		slots.swap(m_slots);
+		m_mask = capacity - 1;
+
+		for(const Triplet<I> &p : slots) {
+			if(isEmptySlot(p)) continue;
+			size_t i = hash(p) & m_mask;
+			while(!isEmptySlot(m_slots[i])) i = (i + 1) & m_mask;
+			m_slots[i] = p;
+		}
 	}
+};
+
+//
+//	Structure-of-arrays block of triplets
+//	x, y and z are held in separate arrays, each aligned to 32 bytes and padded to a multiple of
+//	32 elements, so bulk operations and the batch classifier run over contiguous lanes.
+//	Converts to and from vector<Triplet<I>> for code that wants whole triplets.
+//
+template<class I>
+class TripletBlock
+{
+public:
+	static const size_t ALIGNMENT = 32;
 
-	I determinant() const 
+	TripletBlock()
+		: m_x(nullptr), m_y(nullptr), m_z(nullptr), m_size(0), m_capacity(0) {}
+
+	explicit TripletBlock(const vector<Triplet<I>> &triplets)
+		: TripletBlock()
 	{
-		return
-			  m[0].x * (m[1].y * m[2].z - m[1].z * m[2].y)
-			+ m[0].y * (m[1].z * m[2].x - m[1].x * m[2].z)
-			+ m[0].z * (m[1].x * m[2].y - m[1].y * m[2].x);
+		append(triplets);
 	}
 
-	Triplet<I> centroid() const 
+	TripletBlock(const TripletBlock &rhs)
+		: TripletBlock()
 	{
-		return m[0] + m[1] + m[2];
+		*this = rhs;
 	}
 
-	//	Check whether all 3 columns are coprime and the row sums are coprime.
-	bool isCoprime() const 
+	TripletBlock &operator=(const TripletBlock &rhs)
 	{
-		// if a column has a common factor greater than 1,
-		// then the determinant will be a multiple of that factor.
-		if(determinant() != 1) 
-		{
-			return false;
+		if(this != &rhs) {
+			m_size = 0;
+			reserve(rhs.m_size);
+			std::copy(rhs.m_x, rhs.m_x + rhs.m_size, m_x);
+			std::copy(rhs.m_y, rhs.m_y + rhs.m_size, m_y);
+			std::copy(rhs.m_z, rhs.m_z + rhs.m_size, m_z);
+			m_size = rhs.m_size;
 		}
-		assert(m[0].isCoprime() && m[1].isCoprime() && m[2].isCoprime());
+		return *this;
+	}
 
-		// can this be replaced with a simple check that the determinant is 1? "unimodular"
+	size_t size() const { return m_size; }
+	size_t capacity() const { return m_capacity; }
+	bool empty() const { return m_size == 0; }
+	void clear() { m_size = 0; }
 
-		auto ctr = centroid();
-		if(!ctr.isCoprime()) 
-		{
-			return false;
-		}
+	I *x() { return m_x; }
+	I *y() { return m_y; }
+	I *z() { return m_z; }
+	const I *x() const { return m_x; }
+	const I *y() const { return m_y; }
+	const I *z() const { return m_z; }
 
-		assert(determinant() == 1);
-		return true;
+	Triplet<I> operator[](size_t i) const { return Triplet<I>(m_x[i], m_y[i], m_z[i]); }
+
+	void set(size_t i, const Triplet<I> &p)
+	{
+		m_x[i] = p.x;
+		m_y[i] = p.y;
+		m_z[i] = p.z;
 	}
 
-	//	matrix forms proper, non-collinear, left-winding triangle
-	inline bool isTriangle() const 
+	void reserve(size_t n)
 	{
-		return leftOf(m[0], m[1], m[2]) == 1;
+		if(n <= m_capacity) return;
+		size_t capacity = (std::max)(n, 2 * m_capacity);
+		capacity = (capacity + 31) & ~(size_t)31;
+
+		std::unique_ptr<char[]> buffer(new char[3 * capacity * sizeof(I) + ALIGNMENT]);
+		size_t offset = (ALIGNMENT - (size_t)buffer.get() % ALIGNMENT) % ALIGNMENT;
+		I *x = (I *)(buffer.get() + offset);
+		I *y = x + capacity;
+		I *z = y + capacity;
+		std::copy(m_x, m_x + m_size, x);
+		std::copy(m_y, m_y + m_size, y);
+		std::copy(m_z, m_z + m_size, z);
+
+		m_buffer = std::move(buffer);
+		m_x = x;
+		m_y = y;
+		m_z = z;
+		m_capacity = capacity;
 	}
 
-	/*/	DEPRECATE
-	// returns true if the given point is inside this triangle.
-	// points on the edge of the triangle are considered to be inside.
-	bool isPointInTriangle1(const Triplet<I> &pt) const {
-
-		// compute the point's side relative to the three triangle sides.
-		// here we're computing AB x AP, BC x BP, and CA x CP.
-		// a simple 2D projection is used: the point [Ax, Ay, Az] is mapped to 
-		// (Ax / (Ax+Ay+Az), Ay / (Ax+Ay+Az)).
-		// This projection preserves straight line properties... there's probably
-		// a mathematically simpler way to do this without projection.
-
-		// Any negative cross product means the point lies outside the triangle.
-		// If none are negative, a zero cross product means the point lies on one of the edges.
-
-		// 2d projections
-		I psum = pt.sum(), asum = m[0].sum(), bsum = m[1].sum(), csum = m[2].sum();
-		// double ax = m[0].x / asum, ay = m[0].y / asum;
-		// double bx = m[1].x / bsum, by = m[1].y / bsum;
-		// double cx = m[2].x / csum, cy = m[2].y / csum;
-		// double px = pt.x / psum, py = pt.y / psum;
-		I ax = m[0].x, ay = m[0].y;
-		I bx = m[1].x, by = m[1].y;
-		I cx = m[2].x, cy = m[2].y;
-		I px = pt.x, py = pt.y;
-		// cross products
-		I abs = (asum*bx - bsum*ax)*(asum*py - psum*ay) - (asum*by - bsum*ay)*(asum*px - psum*ax);
-		I bcs = (bsum*cx - csum*bx)*(bsum*py - psum*by) - (bsum*cy - csum*by)*(bsum*px - psum*bx);
-		I cas = (csum*ax - asum*cx)*(csum*py - psum*cy) - (csum*ay - asum*cy)*(csum*px - psum*cx);
-
-		//cerr << "-- " << pt << " AB: " << sign(abs) << " BC: " << sign(bcs) << " CA: " << sign(cas) << endl;
+	void resize(size_t n)
+	{
+		reserve(n);
+		for(size_t i = m_size; i < n; ++i) {
+			m_x[i] = m_y[i] = m_z[i] = 0;
+		}
+		m_size = n;
+	}
 
-		return (abs >= 0 && bcs >= 0 && cas >= 0);
-	}//*/
+	void push_back(const Triplet<I> &p)
+	{
+		if(m_size == m_capacity) reserve(m_size + 1);
+		set(m_size++, p);
+	}
 
-	//
-	//	AKA pointInTriangle
-	//	returns true if the point is inside this triangle or on an edge or vertex
-    //  correct even if dimensions have been collapsed
-	//
-	bool containsPoint(const Triplet<I> &pt) const
+	void append(const vector<Triplet<I>> &triplets)
 	{
-		return leftOf(pt, m[0], m[1]) >= 0
-			&& leftOf(pt, m[1], m[2]) >= 0
-			&& leftOf(pt, m[2], m[0]) >= 0;
+		reserve(m_size + triplets.size());
+		for(auto &p : triplets) set(m_size++, p);
 	}
 
-	//
-	//	AKA triangleInTriangle
-	//	returns true if {tri} is contained entirely within this triangle.
-	//	edges and vertices may touch, so x.containsTriangle(x) would return true.
-	//
-	bool containsTriangle(const TripletTriangle<I> &tri) const
+	void toTriplets(vector<Triplet<I>> &out) const
 	{
-		return containsPoint(tri[0])
-			&& containsPoint(tri[1])
-			&& containsPoint(tri[2]);
+		out.resize(m_size);
+		for(size_t i = 0; i < m_size; ++i) out[i] = (*this)[i];
 	}
 
-	//
-	//	merge transforms
-	//	these preserve the coprime triangle properties:
-	//	- determinant = 1
-	//	- rows, columns, row sums are all coprime triples
-	//	- columns form left-winding triangle
-	//
+	// out[i] = x[i] + y[i] + z[i]
+	void sums(I *out) const
+	{
+		for(size_t i = 0; i < m_size; ++i) out[i] = m_x[i] + m_y[i] + m_z[i];
+	}
 
-    //  if src and dest cols are nonzero,
-    //  toCol += fromCol
-	inline bool merge(int fromCol, int toCol) 
+	// projection to the x+y+z=1 plane, as Triplet::project()
+	void project(float *px, float *py, float *pz) const
 	{
-		assert(fromCol != toCol);
-		assert(fromCol >= 0 && fromCol < 3 && toCol >= 0 && toCol < 3);
-		if(!m[fromCol]) return false;
-		if(!m[toCol]) return false;
-		m[toCol] += m[fromCol];
-		++depth;
-		//assert(isCoprime());
-		//assert(isTriangle());
-		return true;
+		for(size_t i = 0; i < m_size; ++i) {
+			float sum = (float)(m_x[i] + m_y[i] + m_z[i]);
+			px[i] = (float)m_x[i] / sum;
+			py[i] = (float)m_y[i] / sum;
+			pz[i] = (float)m_z[i] / sum;
+		}
 	}
 
-	//inline void mergeAll(int toCol)
-	//{
-	//	depth += 2;
-	//	m[toCol] = centroid();
-	//}
+	// out[i] = gcd(x[i], y[i], z[i]); with AVX2 for int coordinates
+	void gcds(I *out) const
+	{
+		gcds(m_x, m_y, m_z, m_size, out);
+	}
 
-	//	collapse: aggregates two columns by adding; sets a column to zeros
-	//	decreases dimensionality, leaving centroid unchanged
-	inline bool collapse(int ai, int bi)
+	static void gcds(const I *x, const I *y, const I *z, size_t n, I *out)
 	{
-		Triplet<I> before = this->centroid();
-		assert(before.isCoprime());
+		size_t i = 0;
+#ifdef EUCLID_X86
+		if(std::is_same<I, int>::value && cpuHasAvx2()) {
+			i = gcdTripletsAvx2((const int *)x, (const int *)y, (const int *)z, n, (int *)out);
+		}
+#endif
+		for(; i < n; ++i) out[i] = gcdBinary(x[i], y[i], z[i]);
+	}
 
-		assert(ai != bi);
-		assert(ai >= 0 && ai < 3 && bi >= 0 && bi < 3);
+	// removes triplets that are not coprime, keeping the order of the rest. returns the new size
+	size_t filterCoprime()
+	{
+		static const size_t CHUNK = 256;
+		I g[CHUNK];
+		size_t kept = 0;
+		for(size_t begin = 0; begin < m_size; begin += CHUNK) {
+			size_t count = (std::min)(CHUNK, m_size - begin);
+			gcds(m_x + begin, m_y + begin, m_z + begin, count, g);
+			for(size_t i = 0; i < count; ++i) {
+				if(g[i] == 1) {
+					m_x[kept] = m_x[begin + i];
+					m_y[kept] = m_y[begin + i];
+					m_z[kept] = m_z[begin + i];
+					++kept;
+				}
+			}
+		}
+		m_size = kept;
+		return kept;
+	}
 
-        if (ai > bi)
-            std::swap(ai, bi);
+private:
+	std::unique_ptr<char[]> m_buffer;
+	I *m_x, *m_y, *m_z;
+	size_t m_size;
+	size_t m_capacity;
+};
 
-        m[ai] = m[ai] + m[bi];
-        m[bi] = { 0,0,0 };
+//
+//	Compact operator path
+//	Stores a sequence of TripletTriangle::operate() op codes at 4 bits per op.
+//	The 15 common ops (sextant cascades, collapses, and half-merges) take a single nibble;
+//	the rarer quadrant ops (JKLMNO) are written as an escape nibble plus a second nibble.
+//	Paths up to 32 nibbles are stored inline; longer paths spill to the heap.
+//
+//	Nibbles are packed high-first and unused nibbles are kept zero, so byte-wise comparison
+//	orders paths lexicographically by op code and hashing can run over whole bytes.
+//
+class TripletPath
+{
+public:
+	static const unsigned int INLINE_BYTES = 16;
+	static const unsigned int ESCAPE = 15;
 
-        // pack left
-        if (bi == 1)
-        {
-            std::swap(m[1], m[2]);
-        }
+private:
+	union
+	{
+		unsigned char m_inline[INLINE_BYTES];
+		unsigned char *m_heap;
+	};
+	unsigned int m_nibbles = 0;
+	unsigned int m_capacity = 0;		// heap bytes, or 0 if inline
 
+	static const char *opChars() { return "xyzXYZ123lrbBcC"; }
+	static const char *escapedOpChars() { return "JKLMNO"; }
 
-		Triplet<I> ctr = this->centroid();
-        assert(ctr == before);
+public:
+	TripletPath()
+	{
+		memset(m_inline, 0, INLINE_BYTES);
+	}
 
-        ++depth;
-        return true;
+	explicit TripletPath(const string &str)
+	{
+		memset(m_inline, 0, INLINE_BYTES);
+		assign(str);
 	}
 
-	inline void mergeAll()
+	TripletPath(const TripletPath &src)
 	{
-		depth += 1;
-		m[0] = centroid();
+		if(!src.m_capacity)
+		{
+			memcpy(m_inline, src.m_inline, INLINE_BYTES);
+			m_nibbles = src.m_nibbles;
+			return;
+		}
+		memset(m_inline, 0, INLINE_BYTES);
+		*this = src;
 	}
 
-    // 3-dimensional cascade merge
-	// replaces this triangle with one of its sextants.
-	// - vertex[primary] is preserved; 
-	// - vertex[secondary] moves to primary+secondary midpoint;
-	// - remaining vertex moves to centroid.
-	//
-	// same as merge(p, s); merge(s, t);
-	inline bool merge3(int primary, int secondary) 
+	TripletPath(TripletPath &&src) noexcept
 	{
-		// before: x, y, z
-		// after: x, x+y, x+y+z
-        if (!merge(primary, secondary))
-            return false;   // temporary logic here: consider it legal (return true) as long as the first of the merges is complete.. 
-        // this allows more lax code once dimensions have collapsed
+		memcpy(m_inline, src.m_inline, INLINE_BYTES);
+		m_nibbles = src.m_nibbles;
+		m_capacity = src.m_capacity;
+		src.m_capacity = 0;
+		src.m_nibbles = 0;
+		memset(src.m_inline, 0, INLINE_BYTES);
+	}
 
-        merge(secondary, 3 - primary - secondary);
-        return true;
+	~TripletPath()
+	{
+		if(m_capacity) delete[] m_heap;
 	}
 
-	// creates triangle from midpoints--central quadrant
-	// this is a counterexample--breaking the sequential column-merge restriction
-	// causes the centroid to become non-coprime
-	void mergeCenter() 
+	TripletPath& operator=(const TripletPath &src)
 	{
-		auto col0 = m[0];
-		m[0] += m[1];
-		m[1] += m[2];
-		m[2] += col0;
-		++depth;
-		assert(isCoprime());
-		assert(isTriangle());
+		if(this == &src) return *this;
+		unsigned int bytes = (src.m_nibbles + 1) / 2;
+		if(bytes > INLINE_BYTES)
+		{
+			if(bytes > m_capacity)
+			{
+				unsigned char *heap = new unsigned char[src.m_capacity];
+				if(m_capacity) delete[] m_heap;
+				m_heap = heap;
+				m_capacity = src.m_capacity;
+			}
+			memcpy(m_heap, src.data(), bytes);
+			memset(m_heap + bytes, 0, m_capacity - bytes);
+		}
+		else
+		{
+			if(m_capacity) delete[] m_heap;
+			m_capacity = 0;
+			memcpy(m_inline, src.data(), INLINE_BYTES < bytes ? INLINE_BYTES : bytes);
+			memset(m_inline + bytes, 0, INLINE_BYTES - bytes);
+		}
+		m_nibbles = src.m_nibbles;
+		return *this;
 	}
 
-	// rotate columns one to the right. preserves triangle invariants.
-	bool rotate() 
+	TripletPath& operator=(TripletPath &&src) noexcept
 	{
-		auto temp = m[2];
-		m[2] = m[1];
-		m[1] = m[0];
-		m[0] = temp;
-        return true;
+		if(this == &src) return *this;
+		if(m_capacity) delete[] m_heap;
+		memcpy(m_inline, src.m_inline, INLINE_BYTES);
+		m_nibbles = src.m_nibbles;
+		m_capacity = src.m_capacity;
+		src.m_capacity = 0;
+		src.m_nibbles = 0;
+		memset(src.m_inline, 0, INLINE_BYTES);
+		return *this;
 	}
 
-	inline bool operate(char op, const TripletTriangle<I> &src) 
+	bool empty() const { return !m_nibbles; }
+	unsigned int nibbles() const { return m_nibbles; }
+	unsigned int bytes() const { return (m_nibbles + 1) / 2; }
+	const unsigned char *data() const { return m_capacity ? m_heap : m_inline; }
+
+	void clear()
 	{
-		*this = src;
-		return operate(op);
+		if(m_capacity) delete[] m_heap;
+		m_capacity = 0;
+		m_nibbles = 0;
+		memset(m_inline, 0, INLINE_BYTES);
 	}
 
-	bool operate(char op) 
+	// returns the 4-bit code for op, or -1 if op is not a path operator.
+	// escaped ops return ESCAPE + 1 + index
+	static int opCode(char op)
 	{
-		// append to path string
 		switch(op)
 		{
-			case '1': this->path += "{XY}"; break;
-			case '2': this->path += "{YZ}"; break;
-			case '3': this->path += "{ZX}"; break;
-
-			default:
-				this->path += op;
+			case 'x': return 0;
+			case 'y': return 1;
+			case 'z': return 2;
+			case 'X': return 3;
+			case 'Y': return 4;
+			case 'Z': return 5;
+			case '1': return 6;
+			case '2': return 7;
+			case '3': return 8;
+			case 'l': return 9;
+			case 'r': return 10;
+			case 'b': return 11;
+			case 'B': return 12;
+			case 'c': return 13;
+			case 'C': return 14;
+			case 'J': return ESCAPE + 1;
+			case 'K': return ESCAPE + 2;
+			case 'L': return ESCAPE + 3;
+			case 'M': return ESCAPE + 4;
+			case 'N': return ESCAPE + 5;
+			case 'O': return ESCAPE + 6;
+			default: return -1;
 		}
+	}
 
-		// apply operations
-		switch(op)
+	static char opChar(int code)
+	{
+		return (code > (int)ESCAPE) ? escapedOpChars()[code - ESCAPE - 1] : opChars()[code];
+	}
+
+	// appends an op; returns false if op is not a path operator
+	bool push_back(char op)
+	{
+		int code = opCode(op);
+		if(code < 0) return false;
+		if(code > (int)ESCAPE)
 		{
-			// the 6 basic transforms: each divides the parent triangle in half
-			case 'l': return this->merge(1, 0);     // for 2D, equivalent to left on Stern-Brocot tree (smaller fraction value)
-			case 'r': return this->merge(0, 1);     // for 2D, equivalent to right child on Stern-Brocot tree (larger fraction value)
-			case 'b': return this->merge(2, 1);
-			case 'B': return this->merge(1, 2);
-			case 'c': return this->merge(0, 2);
-			case 'C': return this->merge(2, 0);
-			// cascade merges
-			// transforms triangle to one of its parent's sextants
-			// the 6 aggregate transforms: each defines one sixth of the parent triangle
-			case 'x': return this->merge3(0, 1);
-			case 'y': return this->merge3(1, 2);
-			case 'z': return this->merge3(2, 0);
-			case 'X': return this->merge3(0, 2);
-			case 'Y': return this->merge3(1, 0);
-			case 'Z': return this->merge3(2, 1);
-			// alternate sixth division: 3 corner quadrants (like a Sierpinski triangle), 3 inner triangle thirds
-			case 'J': this->merge(0, 1); this->merge(0, 2); break; // X corner quadrant
-			case 'K': this->merge(1, 0); this->merge(1, 2); break; // Y corner quadrant
-			case 'L': this->merge(2, 1); this->merge(2, 0); break; // Z corner quadrant
-			case 'M': this->merge(0, 1); this->merge(2, 0); this->merge(1, 2) && rotate(); break; // X-ward inner 12th, rotated for aesthetics
-			case 'N': this->merge(1, 2); this->merge(0, 1); this->merge(2, 0) && rotate(); break; // Y-ward inner 12th
-			case 'O': this->merge(2, 0); this->merge(1, 2); this->merge(0, 1) && rotate(); break; // Z-ward inner 12th
-			// thirds
-			//case 'u': this->mergeAll(0); break;
-			//case 'v': this->mergeAll(1); break;
-			//case 'w': this->mergeAll(2); break;
-			// dimensionality collapse
-			// returns false if one of the columns is zero
-			case '1': return this->collapse(0, 1); break;
-			case '2': return this->collapse(1, 2); break;
-			case '3': return this->collapse(2, 0); break;
-			// an example of an invalid transform
-			//case 'i': this->mergeCenter(); break;	// center quadrant: INVALID
-			default:
-				return false;
+			pushNibble(ESCAPE);
+			pushNibble(code - ESCAPE - 1);
+		}
+		else
+		{
+			pushNibble(code);
 		}
-
 		return true;
 	}
 
-	// returns sextant classification of point.
-	// characterizes point as left of (-1), right of (+1), or on (0)
-	// each of the 3 median lines.
-	// returns 4-byte value to be interpreted like "-+0"
-	SexClass getSextant(const Triplet<I> &pt) const
+	// removes the last op
+	void pop_back()
 	{
-		// centroid
-		Triplet<I> ctr = this->centroid();
-		assert(ctr.isCoprime());
+		assert(m_nibbles > 0);
+		bool escaped = (m_nibbles >= 2 && nibble(m_nibbles - 2) == ESCAPE);
+		setNibble(--m_nibbles, 0);
+		if(escaped) setNibble(--m_nibbles, 0);
+	}
 
-		if(numColumns() == 2)
+	// shortens the path back to a length previously returned by nibbles()
+	void truncate(unsigned int nibbles)
+	{
+		assert(nibbles <= m_nibbles);
+		while(m_nibbles > nibbles) setNibble(--m_nibbles, 0);
+	}
+
+	// op count; escaped ops count once
+	unsigned int size() const
+	{
+		unsigned int count = 0;
+		for(unsigned int i = 0; i < m_nibbles; ++i, ++count)
 		{
-			// pt better be on the line XY
-			// figure out whether pt is more toward X or Y than ctr.
-			// (pt - ctr) dot (x - ctr)
-			auto p = pt.project();
-			auto c = ctr.project();
-			auto x = m[0].project();
-			vector<float> cp({ p[0] - c[0],p[1] - c[1],p[2] - c[2] });
-			vector<float> cx({ x[0] - c[0],x[1] - c[1],x[2] - c[2] });
-			float dotx = ::dot(cp, cx);
-			//int dotx = (c*pt - p*ctr).dot(c*m[0] - x*ctr)/(c*x*c*p);
-			if(dotx == 0)
-				return SEX00;
-			if(dotx > 0)
-				return SEXX0;
-			return SEXY0;
+			if(nibble(i) == ESCAPE) ++i;
 		}
+		return count;
+	}
 
-		// compute the point's side relative to the three triangle medians.
-		//
-		// here we're computing AB x AP, BC x BP, and CA x CP.
-		// a simple 2D projection is used: the point [Ax, Ay, Az] is mapped to 
-		// (Ax / (Ax+Ay+Az), Ay / (Ax+Ay+Az)).
-		// This projection preserves straight line properties... there's probably
-		// a mathematically simpler way to do this without projection.
+	// calls f(op) for each op char in order
+	template<class F>
+	void forEach(F f) const
+	{
+		forEachCode([&](int code) { f(opChar(code)); });
+	}
 
-		//// reciprocals for 2d projections
-		//I psum = pt.sum(), asum = m[0].sum(), bsum = m[1].sum(), csum = m[2].sum(), msum = ctr.sum();
+	// calls f(code) for each op code in order, as returned by opCode()
+	template<class F>
+	void forEachCode(F f) const
+	{
+		for(unsigned int i = 0; i < m_nibbles; ++i)
+		{
+			int code = nibble(i);
+			if(code == ESCAPE) code = ESCAPE + 1 + nibble(++i);
+			f(code);
+		}
+	}
 
-		//// project to (x/(x+y+z), y/(x+y+z))
-		//// division is delayed, so these values are scaled by ?sum
-		//I ax = m[0].x, ay = m[0].y;
-		//I bx = m[1].x, by = m[1].y;
-		//I cx = m[2].x, cy = m[2].y;
-		//I px = pt.x, py = pt.y;
-		//I mx = ctr.x, my = ctr.y;
-		//I temp;
+	// raw op chars, as accepted by TripletTriangle::operate(): "Z2rl"
+	string ops() const
+	{
+		string str;
+		forEach([&](char op) { str += op; });
+		return str;
+	}
 
-		//// calculate cross-products to characterize P by edges MA, MB, MC
-		//temp = (msum*ax - asum*mx)*(msum*py - psum*my) 
-		//	 - (msum*ay - asum*my)*(msum*px - psum*mx);
-		int maxmp = leftOf(ctr, m[0], pt);
-		//assert(sign(temp) == maxmp);
+	// display form, with collapses spelled out: "Z{YZ}rl"
+	string str() const
+	{
+		string str;
+		forEach([&](char op) {
+			switch(op)
+			{
+				case '1': str += "{XY}"; break;
+				case '2': str += "{YZ}"; break;
+				case '3': str += "{ZX}"; break;
+				default: str += op;
+			}
+		});
+		return str;
+	}
 
-		//temp = (msum*bx - bsum*mx)*(msum*py - psum*my) - (msum*by - bsum*my)*(msum*px - psum*mx);
-		int mbxmp = leftOf(ctr, m[1], pt);
-		//assert(sign(temp) == mbxmp);
+	// parses either op form or display form.
+	// returns false at the first character that isn't an op; ops before it are kept.
+	bool assign(const string &str)
+	{
+		clear();
+		for(size_t i = 0; i < str.size(); ++i)
+		{
+			char op = str[i];
+			if(op == '{')
+			{
+				string pair = str.substr(i, 4);
+				if(pair == "{XY}") op = '1';
+				else if(pair == "{YZ}") op = '2';
+				else if(pair == "{ZX}") op = '3';
+				else return false;
+				i += 3;
+			}
+			if(!push_back(op)) return false;
+		}
+		return true;
+	}
 
-		//temp = (msum*cx - csum*mx)*(msum*py - psum*my) - (msum*cy - csum*my)*(msum*px - psum*mx);
-		int mcxmp = leftOf(ctr, m[2], pt);
-		//assert(sign(temp) == mcxmp);
-
-		//cerr << " {" << signchar(maxmp) << signchar(mbxmp) << signchar(mcxmp) << "}\n";
-
-		SexClass sex(0);
+	//
+	//	Sextant tree addressing
+	//	The 6^depth nodes at a depth of the sextant tree are numbered in pre-order. A node's path
+	//	is then its index in base 6, most significant digit first, with the digits spelled in
+	//	"xyzXYZ" order, which is also their op code order.
+	//
+	static const unsigned int MAX_RANK_DEPTH = 24;		// 6^24 < 2^64
 
-		sex.asChar[0] = signchar(maxmp);
-		sex.asChar[1] = signchar(mbxmp);
-		sex.asChar[2] = signchar(mcxmp);
-		return sex;
+	// number of nodes at depth: 6^depth
+	static unsigned long long rankCount(unsigned int depth)
+	{
+		assert(depth <= MAX_RANK_DEPTH);
+		unsigned long long count = 1;
+		while(depth--) count *= 6;
+		return count;
 	}
 
-	// matrix functions..
+	// the path of node index at depth
+	static TripletPath unrank(unsigned int depth, unsigned long long index)
+	{
+		assert(index < rankCount(depth));
+		TripletPath path;
+		for(unsigned long long digit = rankCount(depth) / 6; depth--; digit /= 6)
+		{
+			path.pushNibble((int)(index / digit));
+			index %= digit;
+		}
+		return path;
+	}
 
-	TripletTriangle transpose() const 
+	// the node index of the path at depth size(); false if an op isn't a sextant cascade
+	bool rank(unsigned long long &index) const
 	{
-		TripletTriangle tri(*this);
-		tri.m[0].y = m[1].x;
-		tri.m[0].z = m[2].x;
-		tri.m[1].x = m[0].y;
-		tri.m[1].z = m[2].y;
-		tri.m[2].x = m[0].z;
-		tri.m[2].y = m[1].z;
-		return tri;
+		if(m_nibbles > MAX_RANK_DEPTH) return false;
+		index = 0;
+		for(unsigned int i = 0; i < m_nibbles; ++i)
+		{
+			int code = nibble(i);
+			if(code > 5) return false;
+			index = index * 6 + code;
+		}
+		return true;
 	}
 
-	void transpose(const TripletTriangle &tri) 
+	bool operator==(const TripletPath &rhs) const
 	{
-		*this = tri;
-		m[0].y = tri.m[1].x;
-		m[0].z = tri.m[2].x;
-		m[1].x = tri.m[0].y;
-		m[1].z = tri.m[2].y;
-		m[2].x = tri.m[0].z;
-		m[2].y = tri.m[1].z;
+		return m_nibbles == rhs.m_nibbles && !memcmp(data(), rhs.data(), bytes());
 	}
 
-	// comparators
+	bool operator!=(const TripletPath &rhs) const { return !(*this == rhs); }
 
-	int operator == (const TripletTriangle &tri) const 
+	// true if this path is rhs or an ancestor of it
+	bool isPrefixOf(const TripletPath &rhs) const
 	{
-		return m[0] == tri.m[0] && m[1] == tri.m[1] && m[2] == tri.m[2];
+		if(m_nibbles > rhs.m_nibbles) return false;
+		for(unsigned int i = 0; i < m_nibbles; ++i)
+		{
+			if(nibble(i) != rhs.nibble(i)) return false;
+		}
+		return true;
 	}
 
-	// returns 1 if {this} is lower priority than {tri}.
-	//
-	// for priority queues, or map keys.
-	// operator < is strict, as it is also used for equality testing.
-	// that is, if x < y, it's guaranteed that !(y<x).
-	// if !(x<y) and !(y<x), then x==y.
-	// This ordering assigns lower values to ...
-	inline int operator < (const TripletTriangle &tri) const 
+	// restores a path from its packed form, as given by data() and nibbles()
+	void assign(const unsigned char *packed, unsigned int nibbles)
 	{
-		int cmp = compare(tri);
-		return (cmp > 0);
+		clear();
+		for(unsigned int i = 0; i < nibbles; ++i)
+		{
+			pushNibble((i & 1) ? (packed[i / 2] & 0x0F) : (packed[i / 2] >> 4));
+		}
 	}
 
-	// returns:
-	// 1 if {this} is lower priority than {tri},
-	// -1 if {this} is higher priority than {tri},
-	// 0 if {this} and {tri} are equal--the same matrix/triangle.
-	int compare(const TripletTriangle &tri) const 
+	// lexicographic by op code; a prefix sorts first
+	bool operator<(const TripletPath &rhs) const
 	{
-		// smaller depth means higher priority
-		if(depth < tri.depth) {
-			return -1;
-		}
-		if(tri.depth < depth) {
-			return 1;	// this is lower priority than tri
-		}
+		unsigned int n = (bytes() < rhs.bytes()) ? bytes() : rhs.bytes();
+		int cmp = memcmp(data(), rhs.data(), n);
+		if(cmp) return cmp < 0;
+		return m_nibbles < rhs.m_nibbles;
+	}
 
-		auto l = this->centroid();
-		auto r = tri.centroid();
-		if(l < r) return 1;
-		if(r < l) return -1;
-		for(int i = 0; i < 3; ++i) {
-			if(m[i] < tri.m[i]) return 1;
-			if(tri.m[i] < m[i]) return -1;
+	size_t hash() const
+	{
+		// FNV-1a
+		unsigned long long h = 14695981039346656037ULL ^ m_nibbles;
+		const unsigned char *p = data();
+		for(unsigned int i = 0, n = bytes(); i < n; ++i)
+		{
+			h = (h ^ p[i]) * 1099511628211ULL;
 		}
-		// they are equal
-		return 0;
+		return (size_t)h;
 	}
 
-	//friend ostream& operator << (ostream &out, const TripletTriangle<I> &m);
-	//friend std::string to_string(const TripletTriangle<int> &tri);
-
-};		// class TripletTriangle
-
-// returns true if the two segments intersect, including endpoint intersections
-template<class I>
-bool segmentsIntersect(const Triplet<I> &a, const Triplet<I> &b, const Triplet<I> &c, const Triplet<I> &d) 
-{
-	int abc = leftOf(a, b, c);
-	int abd = leftOf(a, b, d);
-	if(abc*abd == 1) {
-		// both positive:
-		// C and D lie on the same side of line AB -- no intersection
-		return false;
+private:
+	int nibble(unsigned int i) const
+	{
+		unsigned char b = data()[i / 2];
+		return (i & 1) ? (b & 0x0F) : (b >> 4);
 	}
 
-	// C and D lie on opposite sides of AB
-	// now characterize A and B relative to CD
+	unsigned char *buffer() { return m_capacity ? m_heap : m_inline; }
 
-	int cda = leftOf(c, d, a);
-	int cdb = leftOf(c, d, b);
+	void setNibble(unsigned int i, int v)
+	{
+		unsigned char *p = buffer() + i / 2;
+		*p = (i & 1) ? ((*p & 0xF0) | v) : ((*p & 0x0F) | (v << 4));
+	}
 
-	if(cda*cdb == 1) {
-		// both positive or both negative:
-		// A and B lie on the same side of line CD
-		return false;
+	void pushNibble(int v)
+	{
+		unsigned int needBytes = m_nibbles / 2 + 1;
+		unsigned int haveBytes = m_capacity ? m_capacity : INLINE_BYTES;
+		if(needBytes > haveBytes)
+		{
+			unsigned int capacity = 2 * haveBytes;
+			unsigned char *heap = new unsigned char[capacity];
+			memcpy(heap, data(), haveBytes);
+			memset(heap + haveBytes, 0, capacity - haveBytes);
+			if(m_capacity) delete[] m_heap;
+			m_heap = heap;
+			m_capacity = capacity;
+		}
+		setNibble(m_nibbles++, v);
 	}
+};
 
-	// C and D lie on opposite sides of AB, and A and B lie on opposite sides of CD
-	return true;
+inline ostream& operator << (ostream &out, const TripletPath &path)
+{
+	out << path.str();
+	return out;
+}
+
+namespace std
+{
+	template<>
+	struct hash<TripletPath>
+	{
+		size_t operator()(const TripletPath &path) const { return path.hash(); }
+	};
 }
 
+//
+//	Operators, for compile-time application: tri.apply<Op::x>().
+//	Each value is the op's char, as accepted by TripletTriangle::operate().
+//
+enum class Op : char
+{
+	x = 'x', y = 'y', z = 'z', X = 'X', Y = 'Y', Z = 'Z',
+	l = 'l', r = 'r', b = 'b', B = 'B', c = 'c', C = 'C',
+	J = 'J', K = 'K', L = 'L', M = 'M', N = 'N', O = 'O',
+	XY = '1', YZ = '2', ZX = '3'
+};
+
+template<Op OP> struct TripletOp;
+template<class I> struct TripletOpTable;
+
+//
+//	3x3 integer matrix
+//
 template<class I>
-bool trianglesIntersect(const TripletTriangle<I> &a, const TripletTriangle<I> &b) 
+class TripletTriangle 
 {
-	// if any vertex is inside the other triangle, the triangles overlap
+public:
+	Triplet<I> m[3] = { { 1,0,0 },{ 0,1,0 },{ 0,0,1 } };
+public:
+	TripletPath path;
+	unsigned int depth = 0;
 
-	if(    b.containsPoint(a[0])
-		|| b.containsPoint(a[1])
-		|| b.containsPoint(a[2])
-		|| a.containsPoint(b[0])
-		|| a.containsPoint(b[1])
-		|| a.containsPoint(b[2])) {
-		return true;
+	TripletTriangle() {}
+
+	TripletTriangle(const Triplet<I> &p0, const Triplet<I> &p1, const Triplet<I> &p2) 
+	{
+		m[0] = p0;
+		m[1] = p1;
+		m[2] = p2;
 	}
 
-	// check for edge intersections
+	TripletTriangle(char op, const TripletTriangle<I> &src) 
+	{
+		operate(op, src);
+	}
 
-	for(int i = 0; i < 3; ++i) {
-		for(int j = 0; j < 3; ++j) {
-			if(segmentsIntersect(a[i], a[(i + 1) % 3], b[j], b[(j + 1) % 3])) {
-				return true;
-			}
-		}
+	// the sextant tree node with TripletPath::unrank(depth, index)
+	static TripletTriangle unrank(unsigned int depth, unsigned long long index)
+	{
+		TripletTriangle result;
+		TripletPath::unrank(depth, index).forEach([&](char op) { result.operate(op); });
+		return result;
 	}
 
-	return false;
-}
+	bool isZero() const
+	{
+		return (!m[0] && !m[1] && !m[2]);
+	}
 
-// actually a line-cone intersect: does the line thru point and origin
-// intersect the cone whose axis is the line thru ctr and origin,
-// and whose radius is {radius} at its intersection with the plane x+y+z=1
-// radius
-template<class I>
-bool pointInCircle(const Triplet<I> &point, const Triplet<I> &ctr, float radius) 
-{
-	// project to x+y+z=1
-	float ctrSum = ctr.sum();
-	float vCtr[3] = { ctr.x / ctrSum, ctr.y / ctrSum, ctr.z / ctrSum };
+	TripletTriangle operator+(char op) const
+	{
+		TripletTriangle result(*this);
+        result.operate(op);
+		return result;
+	}
 
-	float pointSum = point.sum();
-	float v[3] = { 
-		point.x / pointSum - vCtr[0], 
-		point.y / pointSum - vCtr[1], 
-		point.z / pointSum - vCtr[2] };
-	return (v[0] * v[0] + v[1] * v[1] + v[2] * v[2] <= (float)radius * radius);
-}
+	//	Reset to identity matrix/basis triangle
+	void reset() 
+	{
+		m[0].set(1, 0, 0);
+		m[1].set(0, 1, 0);
+		m[2].set(0, 0, 1);
+		depth = 0;
+	}
 
-template<class F>
-inline F distsq3(const F *a, const F *b) 
-{
-	F ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
-	return sumsq3(ab);
-}
+	void set(const Triplet<I> &p0, const Triplet<I> &p1, const Triplet<I> &p2) 
+	{
+		m[0] = p0;
+		m[1] = p1;
+		m[2] = p2;
+	}
 
-//	returns true if any part of the line segment is inside a circle
-//	a, b, and ctr should be 3D points on the plane x+y+z=1
-template<class F>
-bool lineSegmentIntersectsCircle(const F *a, const F *b, const F *ctr, F radius) 
-{
-	F rsq = radius * radius;
-	
-	// test both endpoints
-	F ap[3] = { ctr[0] - a[0], ctr[1] - a[1], ctr[2] - a[2] };
-	if(sumsq3(ap) <= rsq) {
-		return true;
+	int numColumns() const
+	{
+		return !!m[0] + !!m[1] + !!m[2];
 	}
 
-	F bp[3] = { ctr[0] - b[0], ctr[1] - b[1], ctr[2] - b[2] };
-	if(sumsq3(bp) <= rsq) {
-		return true;
+	// fetch column / triplet
+	const Triplet<I>& operator [](int idx) const 
+	{
+		assert(idx >= 0 && idx < 3);
+		return m[idx];
 	}
 
-	F ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
-	F abls = sumsq3(ab);
+	// fetch column / triplet
+	Triplet<I>& operator [](int idx) 
+	{
+		assert(idx >= 0 && idx < 3);
+		return m[idx];
+	}
 
-	// distsq(t) = t^2(|AB|^2) + 2t(AB dot PA) + |PA|^2
-	// distsq'(t) = 2t(|AB|^2) + 2(AB dot PA)
-	// min at t=(AB dot PA) / |AB|^2
-	F abdotap = dot3(ab, ap);
-	F t = abdotap / abls;
+	typename Wide<I>::type determinant() const 
+	{
+		typedef typename Wide<I>::type W;
+		return
+			  m[0].x * ((W)m[1].y * m[2].z - (W)m[1].z * m[2].y)
+			+ m[0].y * ((W)m[1].z * m[2].x - (W)m[1].x * m[2].z)
+			+ m[0].z * ((W)m[1].x * m[2].y - (W)m[1].y * m[2].x);
+	}
 
-	if(t < 0 || t > 1) {
-		return false;
+	Triplet<I> centroid() const 
+	{
+		return m[0] + m[1] + m[2];
 	}
 
-	// project ctr onto AB
-	float c[3] = { a[0] + t*ab[0], a[1] + t*ab[1], a[2] + t*ab[2] };
-	return (distsq3(c, ctr) <= rsq);
-}
+	//	Check whether all 3 columns are coprime and the row sums are coprime.
+	bool isCoprime() const 
+	{
+		// if a column has a common factor greater than 1,
+		// then the determinant will be a multiple of that factor.
+		if(determinant() != 1) 
+		{
+			return false;
+		}
+		assert(m[0].isCoprime() && m[1].isCoprime() && m[2].isCoprime());
 
-//	tests whether the line segment ab (projected onto x+y+z=1)
-//	intersects the circle
-template<class I>
-bool lineSegmentIntersectsCircle(const Triplet<I> &a, const Triplet<I> &b, const Triplet<I> &ctr, float radius) 
-{
-	// distsq = |ta + (1-t)b - ctr|^2
-	// = (t(a-b) + b - ctr)^2
-	// = sum[.=x,y,z] t^2 (a-b).^2 + 2t (a-b).(b-ctr). + (b-ctr).^2
-	// distsq' = 2t(a-b). + 2(a-b).(b-ctr).
-	// closest point at t = (b-a)(ctr-b) / (b-a)
-	// min distsq = ((b-a)(b-ctr) + b-ctr)^2
+		// can this be replaced with a simple check that the determinant is 1? "unimodular"
 
-	// point-to-line distance: AB x AP / |AB|
-	// project to x+y+z=1
-	float pSum = ctr.sum();
-	float vp[3] = { ctr.x / pSum, ctr.y / pSum, ctr.z / pSum };
-	float aSum = a.sum();
-	float va[3] = { a.x / aSum, a.y / aSum, a.z / aSum };
-	float bSum = b.sum();
-	float vb[3] = { b.x / bSum, b.y / bSum, b.z / bSum };
+		auto ctr = centroid();
+		if(!ctr.isCoprime()) 
+		{
+			return false;
+		}
 
-	return lineSegmentIntersectsCircle(va, vb, vp, radius);
-}
+		assert(determinant() == 1);
+		return true;
+	}
 
-template<class I>
-bool triangleIntersectsCircle(const TripletTriangle<I> &tri, const Triplet<I> &ctr, float radius) 
-{
-	// if any vertex is inside the circle
-	//if(    pointInCircle(tri[0], ctr, radius)
-	//	|| pointInCircle(tri[1], ctr, radius)
-	//	|| pointInCircle(tri[2], ctr, radius)) {
-	//	return true;
-	//}
+	//	matrix forms proper, non-collinear, left-winding triangle
+	inline bool isTriangle() const 
+	{
+		return leftOf(m[0], m[1], m[2]) == 1;
+	}
 
-	if(tri.numColumns() < 3)
-		cout << "col: " << tri.numColumns() << endl;
+	/*/	DEPRECATE
+	// returns true if the given point is inside this triangle.
+	// points on the edge of the triangle are considered to be inside.
+	bool isPointInTriangle1(const Triplet<I> &pt) const {
 
-	// if circle's center is inside triangle, they intersect
-	if(tri.containsPoint(ctr)) {
+		// compute the point's side relative to the three triangle sides.
+		// here we're computing AB x AP, BC x BP, and CA x CP.
+		// a simple 2D projection is used: the point [Ax, Ay, Az] is mapped to 
+		// (Ax / (Ax+Ay+Az), Ay / (Ax+Ay+Az)).
+		// This projection preserves straight line properties... there's probably
+		// a mathematically simpler way to do this without projection.
+
+		// Any negative cross product means the point lies outside the triangle.
+		// If none are negative, a zero cross product means the point lies on one of the edges.
+
+		// 2d projections
+		I psum = pt.sum(), asum = m[0].sum(), bsum = m[1].sum(), csum = m[2].sum();
+		// double ax = m[0].x / asum, ay = m[0].y / asum;
+		// double bx = m[1].x / bsum, by = m[1].y / bsum;
+		// double cx = m[2].x / csum, cy = m[2].y / csum;
+		// double px = pt.x / psum, py = pt.y / psum;
+		I ax = m[0].x, ay = m[0].y;
+		I bx = m[1].x, by = m[1].y;
+		I cx = m[2].x, cy = m[2].y;
+		I px = pt.x, py = pt.y;
+		// cross products
+		I abs = (asum*bx - bsum*ax)*(asum*py - psum*ay) - (asum*by - bsum*ay)*(asum*px - psum*ax);
+		I bcs = (bsum*cx - csum*bx)*(bsum*py - psum*by) - (bsum*cy - csum*by)*(bsum*px - psum*bx);
+		I cas = (csum*ax - asum*cx)*(csum*py - psum*cy) - (csum*ay - asum*cy)*(csum*px - psum*cx);
+
+		//cerr << "-- " << pt << " AB: " << sign(abs) << " BC: " << sign(bcs) << " CA: " << sign(cas) << endl;
+
+		return (abs >= 0 && bcs >= 0 && cas >= 0);
+	}//*/
+
+	//
+	//	AKA pointInTriangle
+	//	returns true if the point is inside this triangle or on an edge or vertex
+    //  correct even if dimensions have been collapsed
+	//
+	bool containsPoint(const Triplet<I> &pt) const
+	{
+		return leftOf(pt, m[0], m[1]) >= 0
+			&& leftOf(pt, m[1], m[2]) >= 0
+			&& leftOf(pt, m[2], m[0]) >= 0;
+	}
+
+	//
+	//	AKA triangleInTriangle
+	//	returns true if {tri} is contained entirely within this triangle.
+	//	edges and vertices may touch, so x.containsTriangle(x) would return true.
+	//
+	bool containsTriangle(const TripletTriangle<I> &tri) const
+	{
+		return containsPoint(tri[0])
+			&& containsPoint(tri[1])
+			&& containsPoint(tri[2]);
+	}
+
+	//
+	//	merge transforms
+	//	these preserve the coprime triangle properties:
+	//	- determinant = 1
+	//	- rows, columns, row sums are all coprime triples
+	//	- columns form left-winding triangle
+	//
+
+    //  if src and dest cols are nonzero,
+    //  toCol += fromCol
+	inline bool merge(int fromCol, int toCol) 
+	{
+		assert(fromCol != toCol);
+		assert(fromCol >= 0 && fromCol < 3 && toCol >= 0 && toCol < 3);
+		if(!m[fromCol]) return false;
+		if(!m[toCol]) return false;
+		m[toCol] += m[fromCol];
+		++depth;
+		//assert(isCoprime());
+		//assert(isTriangle());
 		return true;
 	}
 
-	// if any triangle vertex lies in circle or any edge intersects circle..
-	if(    lineSegmentIntersectsCircle(tri[0], tri[1], ctr, radius)
-		|| lineSegmentIntersectsCircle(tri[1], tri[2], ctr, radius)
-		|| lineSegmentIntersectsCircle(tri[2], tri[0], ctr, radius)) {
+	//	merge(fromCol, toCol) with the columns fixed at compile time
+	template<int FROM, int TO>
+	inline bool merge()
+	{
+		static_assert(FROM != TO && FROM >= 0 && FROM < 3 && TO >= 0 && TO < 3, "bad merge columns");
+		if(!m[FROM] || !m[TO]) return false;
+		m[TO] += m[FROM];
+		++depth;
 		return true;
 	}
 
-	return false;
-}
+	//inline void mergeAll(int toCol)
+	//{
+	//	depth += 2;
+	//	m[toCol] = centroid();
+	//}
 
-template<class I>
-ostream& operator << (ostream &out, const TripletTriangle<I> &m) 
-{
-	Triplet<I> merge = m.centroid();
+	//	collapse: aggregates two columns by adding; sets a column to zeros
+	//	decreases dimensionality, leaving centroid unchanged
+	inline bool collapse(int ai, int bi)
+	{
+		Triplet<I> before = this->centroid();
+		assert(before.isCoprime());
 
-	bool good = m.isCoprime();
-	char buf[80];
+		assert(ai != bi);
+		assert(ai >= 0 && ai < 3 && bi >= 0 && bi < 3);
 
-	sprintf_s(buf, "%5d %5d %5d   %5d\n", m[0].x, m[1].x, m[2].x, merge.x);
-	out << buf;
-	sprintf_s(buf, "%5d %5d %5d = %5d\n", m[0].y, m[1].y, m[2].y, merge.y);
-	out << buf;
-	sprintf_s(buf, "%5d %5d %5d   %5d   det: %d\n", m[0].z, m[1].z, m[2].z, merge.z, m.determinant());
-	out << buf;
+        if (ai > bi)
+            std::swap(ai, bi);
 
-	//printf("  %s\n", good ? "ok" : "---- BAD!! ----");
-	return out;
-}
+        m[ai] = m[ai] + m[bi];
+        m[bi] = { 0,0,0 };
 
-namespace std
-{
-	std::string to_string(const TripletTriangle<int> &tri)
+        // pack left
+        if (bi == 1)
+        {
+            std::swap(m[1], m[2]);
+        }
+
+
+		Triplet<I> ctr = this->centroid();
+        assert(ctr == before);
+
+        ++depth;
+        return true;
+	}
+
+	inline void mergeAll()
 	{
-		std::ostringstream strstr;
-		strstr << tri;
-		return strstr.str();
+		depth += 1;
+		m[0] = centroid();
 	}
-}
 
+    // 3-dimensional cascade merge
+	// replaces this triangle with one of its sextants.
+	// - vertex[primary] is preserved; 
+	// - vertex[secondary] moves to primary+secondary midpoint;
+	// - remaining vertex moves to centroid.
+	//
+	// same as merge(p, s); merge(s, t);
+	inline bool merge3(int primary, int secondary) 
+	{
+		// before: x, y, z
+		// after: x, x+y, x+y+z
+        if (!merge(primary, secondary))
+            return false;   // temporary logic here: consider it legal (return true) as long as the first of the merges is complete.. 
+        // this allows more lax code once dimensions have collapsed
 
+        merge(secondary, 3 - primary - secondary);
+        return true;
+	}
 
-//
-enum class GrowthEnum
-{
-	NONE = 0, TRIANGLE = 1, CIRCLE, FILL, POINT_SEARCH, STOCHASTIC
-};
+	//	run-length merges: same result as k repetitions of merge/merge3,
+	//	computed directly from the closed form.
 
-constexpr const char * GrowthEnumString(GrowthEnum e)
-{
-	switch(e)
+	//	toCol += k * fromCol
+	inline bool mergeRun(int fromCol, int toCol, I k)
 	{
-	case GrowthEnum::NONE:			return "NONE";
-	case GrowthEnum::TRIANGLE:		return "TRIANGLE";
-	case GrowthEnum::CIRCLE:		return "CIRCLE";
-	case GrowthEnum::FILL:			return "FILL";
-	case GrowthEnum::POINT_SEARCH: return "POINT_SEARCH";
-	case GrowthEnum::STOCHASTIC:	return "STOCHASTIC";
+		assert(fromCol != toCol);
+		assert(k >= 0);
+		if(!m[fromCol]) return false;
+		if(!m[toCol]) return false;
+		m[toCol] += m[fromCol] * k;
+		depth += (unsigned int)k;
+		return true;
 	}
-};
 
-namespace std
-{
-	string to_string(GrowthEnum e)
+	//	k cascade merges:
+	//	before: p, s, t
+	//	after:  p, s + k*p, t + k*s + k(k+1)/2*p
+	inline bool merge3Run(int primary, int secondary, I k)
 	{
-		return GrowthEnumString(e);
+		assert(k >= 0);
+		int tertiary = 3 - primary - secondary;
+		if(!m[primary] || !m[secondary] || !m[tertiary]) return false;
+		m[tertiary] += m[secondary] * k + m[primary] * (k * (k + 1) / 2);
+		m[secondary] += m[primary] * k;
+		depth += 2 * (unsigned int)k;
+		return true;
 	}
-}
 
-template<class I>
-class TripletSearch
-{
-public:
-	// search params
-	Triplet<I> m_target;
-	float m_targetRadius;
-    unsigned int m_maxDepth = 10;
-	unsigned int m_maxHeight;
-	unsigned int m_nMaxTriangleSum = 1000;
-	unsigned int m_maxNumEnumerationResults;
-	TripletTriangle<I> m_clip;
-	string m_operations;
+	// creates triangle from midpoints--central quadrant
+	// this is a counterexample--breaking the sequential column-merge restriction
+	// causes the centroid to become non-coprime
+	void mergeCenter() 
+	{
+		auto col0 = m[0];
+		m[0] += m[1];
+		m[1] += m[2];
+		m[2] += col0;
+		++depth;
+		assert(isCoprime());
+		assert(isTriangle());
+	}
+
+	// rotate columns one to the right. preserves triangle invariants.
+	bool rotate() 
+	{
+		auto temp = m[2];
+		m[2] = m[1];
+		m[1] = m[0];
+		m[0] = temp;
+        return true;
+	}
+
+	inline bool operate(char op, const TripletTriangle<I> &src) 
+	{
+		*this = src;
+		return operate(op);
+	}
+
+	bool operate(char op) 
+	{
+		// append to path
+		this->path.push_back(op);
+
+		return apply(op);
+	}
+
+	// applies op without recording it in path.
+	// the transforms themselves are the TripletOp specializations below
+	bool apply(char op)
+	{
+		switch(op)
+		{
+			case 'l': return apply<Op::l>();
+			case 'r': return apply<Op::r>();
+			case 'b': return apply<Op::b>();
+			case 'B': return apply<Op::B>();
+			case 'c': return apply<Op::c>();
+			case 'C': return apply<Op::C>();
+			case 'x': return apply<Op::x>();
+			case 'y': return apply<Op::y>();
+			case 'z': return apply<Op::z>();
+			case 'X': return apply<Op::X>();
+			case 'Y': return apply<Op::Y>();
+			case 'Z': return apply<Op::Z>();
+			case 'J': return apply<Op::J>();
+			case 'K': return apply<Op::K>();
+			case 'L': return apply<Op::L>();
+			case 'M': return apply<Op::M>();
+			case 'N': return apply<Op::N>();
+			case 'O': return apply<Op::O>();
+			case '1': return apply<Op::XY>();
+			case '2': return apply<Op::YZ>();
+			case '3': return apply<Op::ZX>();
+			// an example of an invalid transform
+			//case 'i': this->mergeCenter(); break;	// center quadrant: INVALID
+			default:
+				return false;
+		}
+	}
+
+	// compile-time forms of operate() and apply(): no op switch, and the merges inline
+	template<Op OP>
+	bool operate()
+	{
+		this->path.push_back((char)OP);
+		return apply<OP>();
+	}
+
+	template<Op OP>
+	bool apply()
+	{
+		return TripletOp<OP>::apply(*this);
+	}
+
+	// returns sextant classification of point.
+	// characterizes point as left of (-1), right of (+1), or on (0)
+	// each of the 3 median lines.
+	// returns 4-byte value to be interpreted like "-+0"
+	SexClass getSextant(const Triplet<I> &pt) const
+	{
+		// centroid
+		Triplet<I> ctr = this->centroid();
+		assert(ctr.isCoprime());
+
+		if(numColumns() == 2)
+		{
+			// pt better be on the line XY
+			// figure out whether pt is more toward X or Y than ctr.
+			return EdgeClassifier(*this).getSextant(pt);
+		}
+
+		// compute the point's side relative to the three triangle medians.
+		//
+		// here we're computing AB x AP, BC x BP, and CA x CP.
+		// a simple 2D projection is used: the point [Ax, Ay, Az] is mapped to 
+		// (Ax / (Ax+Ay+Az), Ay / (Ax+Ay+Az)).
+		// This projection preserves straight line properties... there's probably
+		// a mathematically simpler way to do this without projection.
+
+		//// reciprocals for 2d projections
+		//I psum = pt.sum(), asum = m[0].sum(), bsum = m[1].sum(), csum = m[2].sum(), msum = ctr.sum();
+
+		//// project to (x/(x+y+z), y/(x+y+z))
+		//// division is delayed, so these values are scaled by ?sum
+		//I ax = m[0].x, ay = m[0].y;
+		//I bx = m[1].x, by = m[1].y;
+		//I cx = m[2].x, cy = m[2].y;
+		//I px = pt.x, py = pt.y;
+		//I mx = ctr.x, my = ctr.y;
+		//I temp;
+
+		//// calculate cross-products to characterize P by edges MA, MB, MC
+		//temp = (msum*ax - asum*mx)*(msum*py - psum*my) 
+		//	 - (msum*ay - asum*my)*(msum*px - psum*mx);
+		int maxmp = leftOf(ctr, m[0], pt);
+		//assert(sign(temp) == maxmp);
+
+		//temp = (msum*bx - bsum*mx)*(msum*py - psum*my) - (msum*by - bsum*my)*(msum*px - psum*mx);
+		int mbxmp = leftOf(ctr, m[1], pt);
+		//assert(sign(temp) == mbxmp);
+
+		//temp = (msum*cx - csum*mx)*(msum*py - psum*my) - (msum*cy - csum*my)*(msum*px - psum*mx);
+		int mcxmp = leftOf(ctr, m[2], pt);
+		//assert(sign(temp) == mcxmp);
+
+		//cerr << " {" << signchar(maxmp) << signchar(mbxmp) << signchar(mcxmp) << "}\n";
+
+		SexClass sex(0);
+
+		sex.asChar[0] = signchar(maxmp);
+		sex.asChar[1] = signchar(mbxmp);
+		sex.asChar[2] = signchar(mcxmp);
+		return sex;
+	}
+
+	//
+	//	Exact sextant test for 2 columns, the edge left by a collapse (the Stern-Brocot case).
+	//	On the edge, pt = a*X + b*Y with X = m[0] and Y the other column, and pt lies toward X when
+	//	a > b. Since cross(pt, ctr) = (a - b) * cross(X, Y), the sign of a - b is the sign of one
+	//	component of cross(pt, ctr) against the same component of cross(X, ctr). The largest one is
+	//	used. Both are exact in Wide<I>::type, so points on the centroid of a long run such as
+	//	[1, 1, 500] are never misread as they could be with projected floats.
+	//	Assumes columns with positive sums, as in the tree; pt may have either sign.
+	//
+	class EdgeClassifier
+	{
+	public:
+		EdgeClassifier() {}
+
+		EdgeClassifier(const TripletTriangle &tri) : m_ctr(tri.centroid())
+		{
+			assert(tri.numColumns() == 2);
+			W best = 0;
+			for(int k = 0; k < 3; ++k) {
+				W c = crossComponent(tri[0], m_ctr, k);
+				if(magnitude(c) > magnitude(best)) {
+					best = c;
+					m_axis = k;
+				}
+			}
+			m_sign = sign(best);
+		}
+
+		SexClass getSextant(const Triplet<I> &pt) const
+		{
+			int s = sign(crossComponent(pt, m_ctr, m_axis)) * m_sign * sign(pt.sum());
+			if(s == 0)
+				return SEX00;
+			if(s > 0)
+				return SEXX0;
+			return SEXY0;
+		}
+
+	private:
+		typedef typename Wide<I>::type W;
+
+		Triplet<I> m_ctr;
+		int m_axis = 0;
+		int m_sign = 0;
+
+		// component k of a x b
+		static W crossComponent(const Triplet<I> &a, const Triplet<I> &b, int k)
+		{
+			const I *pa = &a.x, *pb = &b.x;
+			int i = (k + 1) % 3, j = (k + 2) % 3;
+			return (W)pa[i] * pb[j] - (W)pa[j] * pb[i];
+		}
+	};
+
+	//
+	//	Classifies many points against one triangle of 2 or 3 columns.
+	//	leftOf(a, b, c) is the sign of c . (a x b), so the edge and median planes are computed once
+	//	here, and each point then costs a dot product per plane. For 2 columns, the sextant test is
+	//	an EdgeClassifier, as getSextant() uses.
+	//	Results match containsPoint() and getSextant(). Planes and dot products are kept in
+	//	Wide<I>::type, as leftOf() computes them, while every plane component is small enough that
+	//	the dot product can't overflow it; otherwise each test is leftOf() itself, with its double
+	//	filter and exact fallback.
+	//
+	//	containsPoints() and getSextants() classify a block of points given as separate x, y, z
+	//	arrays. For int coordinates they run the AVX2 kernel when the CPU has it and the planes fit
+	//	in 32 bits, and the scalar tests otherwise, or for points the kernel declines.
+	//
+	class PointClassifier
+	{
+	public:
+		bool m_bAllowSimd = true;		// false forces the scalar batch path
+
+		PointClassifier() {}
+
+		PointClassifier(const TripletTriangle &tri)
+		{
+			assert(tri.numColumns() >= 2);
+			Triplet<I> ctr = tri.centroid();
+			m_ctr = ctr;
+			for(int i = 0; i < 3; ++i) {
+				const Triplet<I> &a = tri[i], &b = tri[(i + 1) % 3];
+				m_vertices[i] = a;
+				m_edges[i] = cross(a, b);
+				m_edgeSigns[i] = sign(a.sum()) * sign(b.sum());
+				m_medians[i] = cross(ctr, a);
+				m_medianSigns[i] = sign(ctr.sum()) * sign(a.sum());
+			}
+			m_bWideEdges = widePlanes(m_edges);
+			m_bWideMedians = widePlanes(m_medians);
+
+			m_bTwoColumns = (tri.numColumns() == 2);
+			if(m_bTwoColumns) {
+				m_edge = EdgeClassifier(tri);
+			}
+
+			// the kernel takes the plane signs folded in, and 32-bit planes
+			if(std::is_same<I, int>::value) {
+				m_bSimdEdges = foldPlanes(m_edges, m_edgeSigns, m_simdEdges);
+				m_bSimdMedians = !m_bTwoColumns && foldPlanes(m_medians, m_medianSigns, m_simdMedians);
+			}
+		}
+
+		bool containsPoint(const Triplet<I> &pt) const
+		{
+			return side(pt, true, 0) >= 0 && side(pt, true, 1) >= 0 && side(pt, true, 2) >= 0;
+		}
+
+		SexClass getSextant(const Triplet<I> &pt) const
+		{
+			if(m_bTwoColumns) {
+				return m_edge.getSextant(pt);
+			}
+
+			return planeSigns(pt, false);
+		}
+
+		//	out[i] = containsPoint((x[i], y[i], z[i]))
+		void containsPoints(const I *x, const I *y, const I *z, size_t n, bool *out) const
+		{
+			static const size_t CHUNK = 256;
+			SexClass codes[CHUNK];
+			for(size_t begin = 0; begin < n; begin += CHUNK) {
+				size_t count = (std::min)(CHUNK, n - begin);
+				classifyBatch(m_simdEdges, m_bSimdEdges, x + begin, y + begin, z + begin, count, codes,
+					[this](const Triplet<I> &pt) { return planeSigns(pt, true); });
+				for(size_t i = 0; i < count; ++i) {
+					const char *c = codes[i].asChar;
+					out[begin + i] = (c[0] != '-' && c[1] != '-' && c[2] != '-');
+				}
+			}
+		}
+
+		//	out[i] = getSextant((x[i], y[i], z[i]))
+		void getSextants(const I *x, const I *y, const I *z, size_t n, SexClass *out) const
+		{
+			if(m_bTwoColumns) {
+				for(size_t i = 0; i < n; ++i) out[i] = getSextant(Triplet<I>(x[i], y[i], z[i]));
+				return;
+			}
+			classifyBatch(m_simdMedians, m_bSimdMedians, x, y, z, n, out,
+				[this](const Triplet<I> &pt) { return planeSigns(pt, false); });
+		}
+
+		void containsPoints(const TripletBlock<I> &block, bool *out) const
+		{
+			containsPoints(block.x(), block.y(), block.z(), block.size(), out);
+		}
+
+		void getSextants(const TripletBlock<I> &block, SexClass *out) const
+		{
+			getSextants(block.x(), block.y(), block.z(), block.size(), out);
+		}
+
+	private:
+		typedef typename Wide<I>::type W;
+
+		long long m_simdEdges[3][3];
+		long long m_simdMedians[3][3];
+		bool m_bSimdEdges = false;
+		bool m_bSimdMedians = false;
+
+		//	leftOf(pt, a, b) for edge (a, b) or median (ctr, a) k
+		int side(const Triplet<I> &pt, bool bEdge, int k) const
+		{
+			if(bEdge ? m_bWideEdges : m_bWideMedians) {
+				int signs = bEdge ? m_edgeSigns[k] : m_medianSigns[k];
+				return sign(pt.sum()) * signs * sign(dot(pt, bEdge ? m_edges[k] : m_medians[k]));
+			}
+			return bEdge ? leftOf(pt, m_vertices[k], m_vertices[(k + 1) % 3]) : leftOf(pt, m_ctr, m_vertices[k]);
+		}
+
+		SexClass planeSigns(const Triplet<I> &pt, bool bEdges) const
+		{
+			SexClass sex(0);
+			for(int i = 0; i < 3; ++i) {
+				sex.asChar[i] = signchar(side(pt, bEdges, i));
+			}
+			return sex;
+		}
+
+		//	|pt| < 2^(bits of I - 1), so pt . plane fits W while each component is below 2^limBits,
+		//	the same limit as leftOf()'s
+		static bool widePlanes(const Triplet<W> planes[3])
+		{
+			const int limBits = 8 * (int)(sizeof(W) - sizeof(I)) - 3;
+			if(limBits <= 0) return false;
+			const W lim = (W)1 << (limBits > 0 ? limBits : 0);
+			for(int k = 0; k < 3; ++k) {
+				if(magnitude(planes[k].x) >= lim || magnitude(planes[k].y) >= lim || magnitude(planes[k].z) >= lim) return false;
+			}
+			return true;
+		}
+
+		static bool foldPlanes(const Triplet<W> planes[3], const int signs[3], long long folded[3][3])
+		{
+			for(int k = 0; k < 3; ++k) {
+				W p[3] = { planes[k].x * signs[k], planes[k].y * signs[k], planes[k].z * signs[k] };
+				for(int j = 0; j < 3; ++j) {
+					if(magnitude(p[j]) >= ((W)1 << 31)) return false;
+					folded[k][j] = (long long)p[j];
+				}
+			}
+			return true;
+		}
+
+		//	the AVX2 kernel where allowed, scalar for the points it declines and the tail
+		template<class F>
+		void classifyBatch(const long long planes[3][3], bool bSimdPlanes,
+			const I *x, const I *y, const I *z, size_t n, SexClass *out, F scalar) const
+		{
+			bool bSimd = false;
+#ifdef EUCLID_X86
+			bSimd = bSimdPlanes && m_bAllowSimd && cpuHasAvx2();
+#endif
+			size_t i = 0;
+			while(i < n) {
+#ifdef EUCLID_X86
+				if(bSimd) {
+					i += classifyPlanesAvx2(planes, (const int *)x + i, (const int *)y + i, (const int *)z + i, n - i, out + i);
+				}
+#endif
+				size_t end = (std::min)(n, i + 4);
+				for(; i < end; ++i) out[i] = scalar(Triplet<I>(x[i], y[i], z[i]));
+			}
+		}
+
+		Triplet<W> m_edges[3];
+		Triplet<W> m_medians[3];
+		int m_edgeSigns[3];
+		int m_medianSigns[3];
+		Triplet<I> m_vertices[3];
+		Triplet<I> m_ctr;
+		bool m_bWideEdges = false;		// dot products with the planes can't overflow W
+		bool m_bWideMedians = false;
+		bool m_bTwoColumns = false;
+		EdgeClassifier m_edge;		// 2 columns
+
+		static Triplet<W> cross(const Triplet<I> &a, const Triplet<I> &b)
+		{
+			return Triplet<W>((W)a.y*b.z - (W)a.z*b.y, (W)a.z*b.x - (W)a.x*b.z, (W)a.x*b.y - (W)a.y*b.x);
+		}
+
+		static W dot(const Triplet<I> &a, const Triplet<W> &b)
+		{
+			return a.x*b.x + a.y*b.y + a.z*b.z;
+		}
+	};
+
+	// matrix functions..
+
+	TripletTriangle transpose() const 
+	{
+		TripletTriangle tri(*this);
+		tri.m[0].y = m[1].x;
+		tri.m[0].z = m[2].x;
+		tri.m[1].x = m[0].y;
+		tri.m[1].z = m[2].y;
+		tri.m[2].x = m[0].z;
+		tri.m[2].y = m[1].z;
+		return tri;
+	}
+
+	void transpose(const TripletTriangle &tri) 
+	{
+		*this = tri;
+		m[0].y = tri.m[1].x;
+		m[0].z = tri.m[2].x;
+		m[1].x = tri.m[0].y;
+		m[1].z = tri.m[2].y;
+		m[2].x = tri.m[0].z;
+		m[2].y = tri.m[1].z;
+	}
+
+	// comparators
+
+	int operator == (const TripletTriangle &tri) const 
+	{
+		return m[0] == tri.m[0] && m[1] == tri.m[1] && m[2] == tri.m[2];
+	}
+
+	// returns 1 if {this} is lower priority than {tri}.
+	//
+	// for priority queues, or map keys.
+	// operator < is strict, as it is also used for equality testing.
+	// that is, if x < y, it's guaranteed that !(y<x).
+	// if !(x<y) and !(y<x), then x==y.
+	// This ordering assigns lower values to ...
+	inline int operator < (const TripletTriangle &tri) const 
+	{
+		int cmp = compare(tri);
+		return (cmp > 0);
+	}
+
+	// returns:
+	// 1 if {this} is lower priority than {tri},
+	// -1 if {this} is higher priority than {tri},
+	// 0 if {this} and {tri} are equal--the same matrix/triangle.
+	int compare(const TripletTriangle &tri) const 
+	{
+		// smaller depth means higher priority
+		if(depth < tri.depth) {
+			return -1;
+		}
+		if(tri.depth < depth) {
+			return 1;	// this is lower priority than tri
+		}
+
+		auto l = this->centroid();
+		auto r = tri.centroid();
+		if(l < r) return 1;
+		if(r < l) return -1;
+		for(int i = 0; i < 3; ++i) {
+			if(m[i] < tri.m[i]) return 1;
+			if(tri.m[i] < m[i]) return -1;
+		}
+		// they are equal
+		return 0;
+	}
+
+	//friend ostream& operator << (ostream &out, const TripletTriangle<I> &m);
+	//friend std::string to_string(const TripletTriangle<int> &tri);
+
+};		// class TripletTriangle
+
+//
+//	Compile-time operators
+//	TripletOp<op>::apply(tri) performs op's column merges on tri, with the columns fixed at
+//	compile time. TripletTriangle::apply(char) and apply<Op>() both land here.
+//
+
+//	toCol += fromCol
+template<int FROM, int TO>
+struct MergeOp
+{
+	template<class I>
+	static bool apply(TripletTriangle<I> &t) { return t.template merge<FROM, TO>(); }
+};
+
+//	cascade merge, as TripletTriangle::merge3(): legal as long as the first merge is
+template<int P, int S>
+struct Merge3Op
+{
+	template<class I>
+	static bool apply(TripletTriangle<I> &t)
+	{
+		if(!t.template merge<P, S>()) return false;
+		t.template merge<S, 3 - P - S>();
+		return true;
+	}
+};
+
+//	corner quadrant: column P is merged into both others
+template<int P, int A, int B>
+struct QuadrantOp
+{
+	template<class I>
+	static bool apply(TripletTriangle<I> &t)
+	{
+		t.template merge<P, A>();
+		t.template merge<P, B>();
+		return true;
+	}
+};
+
+//	inner twelfth: merges A into B, C into A, then B into C, rotated for aesthetics
+template<int A, int B, int C>
+struct InnerOp
+{
+	template<class I>
+	static bool apply(TripletTriangle<I> &t)
+	{
+		t.template merge<A, B>();
+		t.template merge<C, A>();
+		t.template merge<B, C>() && t.rotate();
+		return true;
+	}
+};
+
+//	dimensionality collapse; false if one of the columns is zero
+template<int A, int B>
+struct CollapseOp
+{
+	template<class I>
+	static bool apply(TripletTriangle<I> &t) { return t.collapse(A, B); }
+};
+
+// the 6 basic transforms: each divides the parent triangle in half
+template<> struct TripletOp<Op::l> : MergeOp<1, 0> {};		// for 2D, equivalent to left on Stern-Brocot tree (smaller fraction value)
+template<> struct TripletOp<Op::r> : MergeOp<0, 1> {};		// for 2D, equivalent to right child on Stern-Brocot tree (larger fraction value)
+template<> struct TripletOp<Op::b> : MergeOp<2, 1> {};
+template<> struct TripletOp<Op::B> : MergeOp<1, 2> {};
+template<> struct TripletOp<Op::c> : MergeOp<0, 2> {};
+template<> struct TripletOp<Op::C> : MergeOp<2, 0> {};
+// cascade merges
+// transforms triangle to one of its parent's sextants
+// the 6 aggregate transforms: each defines one sixth of the parent triangle
+template<> struct TripletOp<Op::x> : Merge3Op<0, 1> {};
+template<> struct TripletOp<Op::y> : Merge3Op<1, 2> {};
+template<> struct TripletOp<Op::z> : Merge3Op<2, 0> {};
+template<> struct TripletOp<Op::X> : Merge3Op<0, 2> {};
+template<> struct TripletOp<Op::Y> : Merge3Op<1, 0> {};
+template<> struct TripletOp<Op::Z> : Merge3Op<2, 1> {};
+// alternate sixth division: 3 corner quadrants (like a Sierpinski triangle), 3 inner triangle thirds
+template<> struct TripletOp<Op::J> : QuadrantOp<0, 1, 2> {};	// X corner quadrant
+template<> struct TripletOp<Op::K> : QuadrantOp<1, 0, 2> {};	// Y corner quadrant
+template<> struct TripletOp<Op::L> : QuadrantOp<2, 1, 0> {};	// Z corner quadrant
+template<> struct TripletOp<Op::M> : InnerOp<0, 1, 2> {};		// X-ward inner 12th
+template<> struct TripletOp<Op::N> : InnerOp<1, 2, 0> {};		// Y-ward inner 12th
+template<> struct TripletOp<Op::O> : InnerOp<2, 0, 1> {};		// Z-ward inner 12th
+// dimensionality collapse
+template<> struct TripletOp<Op::XY> : CollapseOp<0, 1> {};
+template<> struct TripletOp<Op::YZ> : CollapseOp<1, 2> {};
+template<> struct TripletOp<Op::ZX> : CollapseOp<2, 0> {};
+
+//
+//	Runtime dispatch for op strings such as m_operations.
+//	lookup() maps an op char to its transform; compile() resolves a whole string once, so a loop
+//	over its ops makes one indirect call per op instead of running the op switch.
+//
+template<class I>
+struct TripletOpTable
+{
+	typedef bool (*ApplyFn)(TripletTriangle<I> &);
+
+	struct CompiledOp
+	{
+		char op;
+		ApplyFn apply;
+	};
+
+	ApplyFn fns[128];
+
+	TripletOpTable() : fns()
+	{
+		add<Op::x>(); add<Op::y>(); add<Op::z>(); add<Op::X>(); add<Op::Y>(); add<Op::Z>();
+		add<Op::l>(); add<Op::r>(); add<Op::b>(); add<Op::B>(); add<Op::c>(); add<Op::C>();
+		add<Op::J>(); add<Op::K>(); add<Op::L>(); add<Op::M>(); add<Op::N>(); add<Op::O>();
+		add<Op::XY>(); add<Op::YZ>(); add<Op::ZX>();
+	}
+
+	// nullptr if op is not an operator
+	static ApplyFn lookup(char op)
+	{
+		static const TripletOpTable table;
+		return ((unsigned char)op < 128) ? table.fns[(unsigned char)op] : nullptr;
+	}
+
+	// ops in order; chars that are not operators are dropped
+	static vector<CompiledOp> compile(const string &ops)
+	{
+		vector<CompiledOp> compiled;
+		for(char op : ops) {
+			ApplyFn fn = lookup(op);
+			if(fn) compiled.push_back({ op, fn });
+		}
+		return compiled;
+	}
+
+private:
+	template<Op OP>
+	void add() { fns[(unsigned char)OP] = &TripletOp<OP>::template apply<I>; }
+};
+
+//
+//	A fixed op alphabet, for traversal kernels instantiated per alphabet.
+//	forEachChild() expands to one inlined transform per op, with no dispatch at all.
+//
+template<Op... OPS>
+struct TripletOpAlphabet
+{
+	static const size_t SIZE = sizeof...(OPS);
+
+	// the alphabet as an op string
+	static const char *str()
+	{
+		static const char ops[] = { (char)OPS..., 0 };
+		return ops;
+	}
+
+	// f(op, child) for each op that applies to parent. child.path is left empty
+	template<class I, class F>
+	static void forEachChild(const TripletTriangle<I> &parent, F f)
+	{
+		int expand[] = { 0, (visitChild<OPS>(parent, f), 0)... };
+		(void)expand;
+	}
+
+	// depth-first over the subtree below root, down to maxDepth levels.
+	// visit(triangle, depth) returns false to prune below triangle
+	template<class I, class F>
+	static void traverse(const TripletTriangle<I> &root, unsigned int maxDepth, F visit, unsigned int depth = 0)
+	{
+		if(!visit(root, depth) || depth >= maxDepth) return;
+		forEachChild(root, [&](char, const TripletTriangle<I> &child) {
+			traverse(child, maxDepth, visit, depth + 1);
+		});
+	}
+
+private:
+	template<Op OP, class I, class F>
+	static void visitChild(const TripletTriangle<I> &parent, F &f)
+	{
+		TripletTriangle<I> child;
+		child.set(parent[0], parent[1], parent[2]);
+		child.depth = parent.depth;
+		if(TripletOp<OP>::apply(child)) f((char)OP, child);
+	}
+};
+
+typedef TripletOpAlphabet<Op::x, Op::y, Op::z, Op::X, Op::Y, Op::Z> SextantOps;
+
+//
+//	Block-composed path evaluation
+//	On a triangle with 3 independent columns, each sextant op is a fixed unimodular map: it
+//	right-multiplies the column matrix by the op's matrix. The evaluator precomputes the product
+//	for every block of up to k sextant ops (6 + 36 + ... + 6^k of them), then replays a path a
+//	block at a time with one 3x3 product per block. Any other op, or any op once a collapse has
+//	zeroed a column, goes through TripletTriangle::apply().
+//
+//	The batch form shares work between consecutive paths with the same leading blocks, so
+//	replaying paths in sorted order (TripletPath::operator<) saves the most.
+//
+template<class I>
+class TripletPathEvaluator
+{
+public:
+	static const int MAX_BLOCK_OPS = 6;
+
+	explicit TripletPathEvaluator(int blockOps = 4) : m_blockOps(blockOps)
+	{
+		assert(blockOps >= 1 && blockOps <= MAX_BLOCK_OPS);
+		// blocks of length L start at offset (6^L - 6) / 5; each extends its prefix by one op
+		m_offsets[1] = 0;
+		size_t count = 6;
+		for(int length = 1; length <= blockOps; ++length, count *= 6) {
+			if(length > 1) m_offsets[length] = m_offsets[length - 1] + count / 6;
+			for(size_t index = 0; index < count; ++index) {
+				TripletTriangle<I> tri;
+				if(length > 1) {
+					const Block &prefix = m_blocks[m_offsets[length - 1] + index / 6];
+					tri.set(prefix.c[0], prefix.c[1], prefix.c[2]);
+					tri.depth = prefix.depth;
+				}
+				tri.apply("xyzXYZ"[index % 6]);
+				m_blocks.push_back({ { tri[0], tri[1], tri[2] }, tri.depth });
+			}
+		}
+	}
+
+	int blockOps() const { return m_blockOps; }
+
+	//	the triangle reached by applying path to root, with its path set
+	TripletTriangle<I> evaluate(const TripletPath &path, const TripletTriangle<I> &root = TripletTriangle<I>()) const
+	{
+		TripletTriangle<I> result;
+		result.set(root[0], root[1], root[2]);
+		result.depth = root.depth;
+		vector<unsigned char> codes;
+		decode(path, codes);
+		finish(codes, 0, result);
+		result.path = root.path;
+		appendPath(result.path, path);
+		return result;
+	}
+
+	//	out[i] = evaluate(paths[i], root)
+	void evaluate(const vector<TripletPath> &paths, vector<TripletTriangle<I>> &out, const TripletTriangle<I> &root = TripletTriangle<I>()) const
+	{
+		out.resize(paths.size());
+
+		// frames[b] holds the state after the first b whole blocks of the previous path
+		vector<Frame> frames;
+		vector<unsigned char> previous, codes;
+		bool bFull = (root.numColumns() == 3);
+		frames.push_back({ { root[0], root[1], root[2] }, root.depth });
+
+		for(size_t i = 0; i < paths.size(); ++i) {
+			decode(paths[i], codes);
+
+			size_t common = 0;
+			while(common < codes.size() && common < previous.size() && codes[common] == previous[common]) ++common;
+			size_t keep = (std::min)(frames.size() - 1, common / m_blockOps);
+			frames.resize(keep + 1);
+
+			TripletTriangle<I> &result = out[i];
+			result.set(frames.back().m[0], frames.back().m[1], frames.back().m[2]);
+			result.depth = frames.back().depth;
+			size_t pos = keep * m_blockOps;
+
+			// whole leading blocks are kept for the next path
+			size_t index;
+			while(bFull && pos + m_blockOps <= codes.size() && blockIndex(codes, pos, m_blockOps, index)) {
+				multiply(result, m_blocks[m_offsets[m_blockOps] + index]);
+				frames.push_back({ { result[0], result[1], result[2] }, result.depth });
+				pos += m_blockOps;
+			}
+			finish(codes, pos, result);
+
+			result.path = root.path;
+			appendPath(result.path, paths[i]);
+			previous.swap(codes);
+		}
+	}
+
+private:
+	struct Block
+	{
+		Triplet<I> c[3];		// the block applied to the identity
+		unsigned int depth;
+	};
+
+	struct Frame
+	{
+		Triplet<I> m[3];
+		unsigned int depth;
+	};
+
+	int m_blockOps;
+	size_t m_offsets[MAX_BLOCK_OPS + 1];
+	vector<Block> m_blocks;
+
+	static void decode(const TripletPath &path, vector<unsigned char> &codes)
+	{
+		codes.clear();
+		path.forEachCode([&](int code) { codes.push_back((unsigned char)code); });
+	}
+
+	static void appendPath(TripletPath &dest, const TripletPath &path)
+	{
+		if(dest.empty()) dest = path;
+		else path.forEach([&](char op) { dest.push_back(op); });
+	}
+
+	// base-6 index of codes[pos, pos + length), first op most significant; false if any isn't a sextant op
+	static bool blockIndex(const vector<unsigned char> &codes, size_t pos, int length, size_t &index)
+	{
+		index = 0;
+		for(int i = 0; i < length; ++i) {
+			if(codes[pos + i] >= 6) return false;
+			index = index * 6 + codes[pos + i];
+		}
+		return true;
+	}
+
+	// columns := columns * block
+	static void multiply(TripletTriangle<I> &tri, const Block &block)
+	{
+		Triplet<I> m0 = tri[0], m1 = tri[1], m2 = tri[2];
+		for(int j = 0; j < 3; ++j) {
+			const Triplet<I> &c = block.c[j];
+			tri[j] = m0 * c.x + m1 * c.y + m2 * c.z;
+		}
+		tri.depth += block.depth;
+	}
+
+	// applies codes[pos..] to tri: runs of sextant ops by block while all 3 columns are nonzero, the rest one by one
+	void finish(const vector<unsigned char> &codes, size_t pos, TripletTriangle<I> &tri) const
+	{
+		while(pos < codes.size()) {
+			if(codes[pos] < 6 && tri.numColumns() == 3) {
+				int length = 1;
+				while(length < m_blockOps && pos + length < codes.size() && codes[pos + length] < 6) ++length;
+				size_t index;
+				blockIndex(codes, pos, length, index);
+				multiply(tri, m_blocks[m_offsets[length] + index]);
+				pos += length;
+			}
+			else {
+				tri.apply(TripletPath::opChar(codes[pos++]));
+			}
+		}
+	}
+};
+
+// returns true if the two segments intersect, including endpoint intersections
+template<class I>
+bool segmentsIntersect(const Triplet<I> &a, const Triplet<I> &b, const Triplet<I> &c, const Triplet<I> &d) 
+{
+	int abc = leftOf(a, b, c);
+	int abd = leftOf(a, b, d);
+	if(abc*abd == 1) {
+		// both positive:
+		// C and D lie on the same side of line AB -- no intersection
+		return false;
+	}
+
+	// C and D lie on opposite sides of AB
+	// now characterize A and B relative to CD
+
+	int cda = leftOf(c, d, a);
+	int cdb = leftOf(c, d, b);
+
+	if(cda*cdb == 1) {
+		// both positive or both negative:
+		// A and B lie on the same side of line CD
+		return false;
+	}
+
+	// C and D lie on opposite sides of AB, and A and B lie on opposite sides of CD
+	return true;
+}
+
+template<class I>
+bool trianglesIntersect(const TripletTriangle<I> &a, const TripletTriangle<I> &b) 
+{
+	// if any vertex is inside the other triangle, the triangles overlap
+
+	if(    b.containsPoint(a[0])
+		|| b.containsPoint(a[1])
+		|| b.containsPoint(a[2])
+		|| a.containsPoint(b[0])
+		|| a.containsPoint(b[1])
+		|| a.containsPoint(b[2])) {
+		return true;
+	}
+
+	// check for edge intersections
+
+	for(int i = 0; i < 3; ++i) {
+		for(int j = 0; j < 3; ++j) {
+			if(segmentsIntersect(a[i], a[(i + 1) % 3], b[j], b[(j + 1) % 3])) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// actually a line-cone intersect: does the line thru point and origin
+// intersect the cone whose axis is the line thru ctr and origin,
+// and whose radius is {radius} at its intersection with the plane x+y+z=1
+// radius
+template<class I>
+bool pointInCircle(const Triplet<I> &point, const Triplet<I> &ctr, float radius) 
+{
+	// project to x+y+z=1
+	float ctrSum = ctr.sum();
+	float vCtr[3] = { ctr.x / ctrSum, ctr.y / ctrSum, ctr.z / ctrSum };
+
+	float pointSum = point.sum();
+	float v[3] = { 
+		point.x / pointSum - vCtr[0], 
+		point.y / pointSum - vCtr[1], 
+		point.z / pointSum - vCtr[2] };
+	return (v[0] * v[0] + v[1] * v[1] + v[2] * v[2] <= (float)radius * radius);
+}
+
+template<class F>
+inline F distsq3(const F *a, const F *b) 
+{
+	F ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	return sumsq3(ab);
+}
+
+//	returns true if any part of the line segment is inside a circle
+//	a, b, and ctr should be 3D points on the plane x+y+z=1
+template<class F>
+bool lineSegmentIntersectsCircle(const F *a, const F *b, const F *ctr, F radius) 
+{
+	F rsq = radius * radius;
+	
+	// test both endpoints
+	F ap[3] = { ctr[0] - a[0], ctr[1] - a[1], ctr[2] - a[2] };
+	if(sumsq3(ap) <= rsq) {
+		return true;
+	}
+
+	F bp[3] = { ctr[0] - b[0], ctr[1] - b[1], ctr[2] - b[2] };
+	if(sumsq3(bp) <= rsq) {
+		return true;
+	}
+
+	F ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	F abls = sumsq3(ab);
+
+	// distsq(t) = t^2(|AB|^2) + 2t(AB dot PA) + |PA|^2
+	// distsq'(t) = 2t(|AB|^2) + 2(AB dot PA)
+	// min at t=(AB dot PA) / |AB|^2
+	F abdotap = dot3(ab, ap);
+	F t = abdotap / abls;
+
+	if(t < 0 || t > 1) {
+		return false;
+	}
+
+	// project ctr onto AB
+	float c[3] = { a[0] + t*ab[0], a[1] + t*ab[1], a[2] + t*ab[2] };
+	return (distsq3(c, ctr) <= rsq);
+}
+
+//	tests whether the line segment ab (projected onto x+y+z=1)
+//	intersects the circle
+template<class I>
+bool lineSegmentIntersectsCircle(const Triplet<I> &a, const Triplet<I> &b, const Triplet<I> &ctr, float radius) 
+{
+	// distsq = |ta + (1-t)b - ctr|^2
+	// = (t(a-b) + b - ctr)^2
+	// = sum[.=x,y,z] t^2 (a-b).^2 + 2t (a-b).(b-ctr). + (b-ctr).^2
+	// distsq' = 2t(a-b). + 2(a-b).(b-ctr).
+	// closest point at t = (b-a)(ctr-b) / (b-a)
+	// min distsq = ((b-a)(b-ctr) + b-ctr)^2
+
+	// point-to-line distance: AB x AP / |AB|
+	// project to x+y+z=1
+	float pSum = ctr.sum();
+	float vp[3] = { ctr.x / pSum, ctr.y / pSum, ctr.z / pSum };
+	float aSum = a.sum();
+	float va[3] = { a.x / aSum, a.y / aSum, a.z / aSum };
+	float bSum = b.sum();
+	float vb[3] = { b.x / bSum, b.y / bSum, b.z / bSum };
+
+	return lineSegmentIntersectsCircle(va, vb, vp, radius);
+}
+
+template<class I>
+bool triangleIntersectsCircle(const TripletTriangle<I> &tri, const Triplet<I> &ctr, float radius) 
+{
+	// if any vertex is inside the circle
+	//if(    pointInCircle(tri[0], ctr, radius)
+	//	|| pointInCircle(tri[1], ctr, radius)
+	//	|| pointInCircle(tri[2], ctr, radius)) {
+	//	return true;
+	//}
+
+	if(tri.numColumns() < 3)
+		cout << "col: " << tri.numColumns() << endl;
+
+	// if circle's center is inside triangle, they intersect
+	if(tri.containsPoint(ctr)) {
+		return true;
+	}
+
+	// if any triangle vertex lies in circle or any edge intersects circle..
+	if(    lineSegmentIntersectsCircle(tri[0], tri[1], ctr, radius)
+		|| lineSegmentIntersectsCircle(tri[1], tri[2], ctr, radius)
+		|| lineSegmentIntersectsCircle(tri[2], tri[0], ctr, radius)) {
+		return true;
+	}
+
+	return false;
+}
+
+template<class I>
+ostream& operator << (ostream &out, const TripletTriangle<I> &m) 
+{
+	Triplet<I> merge = m.centroid();
+
+	bool good = m.isCoprime();
+
+	out << setw(5) << m[0].x << " " << setw(5) << m[1].x << " " << setw(5) << m[2].x << "   " << setw(5) << merge.x << "\n";
+	out << setw(5) << m[0].y << " " << setw(5) << m[1].y << " " << setw(5) << m[2].y << " = " << setw(5) << merge.y << "\n";
+	out << setw(5) << m[0].z << " " << setw(5) << m[1].z << " " << setw(5) << m[2].z << "   " << setw(5) << merge.z << "   det: " << m.determinant() << "\n";
+
+	//printf("  %s\n", good ? "ok" : "---- BAD!! ----");
+	return out;
+}
+
+namespace std
+{
+	template<class I>
+	std::string to_string(const TripletTriangle<I> &tri)
+	{
+		std::ostringstream strstr;
+		strstr << tri;
+		return strstr.str();
+	}
+}
+
+
+
+//
+enum class GrowthEnum
+{
+	NONE = 0, TRIANGLE = 1, CIRCLE, FILL, POINT_SEARCH, STOCHASTIC
+};
+
+constexpr const char * GrowthEnumString(GrowthEnum e)
+{
+	switch(e)
+	{
+	case GrowthEnum::NONE:			return "NONE";
+	case GrowthEnum::TRIANGLE:		return "TRIANGLE";
+	case GrowthEnum::CIRCLE:		return "CIRCLE";
+	case GrowthEnum::FILL:			return "FILL";
+	case GrowthEnum::POINT_SEARCH: return "POINT_SEARCH";
+	case GrowthEnum::STOCHASTIC:	return "STOCHASTIC";
+	}
+};
+
+namespace std
+{
+	string to_string(GrowthEnum e)
+	{
+		return GrowthEnumString(e);
+	}
+}
+
+template<class I> class ShardedEnumeration;
+template<class I> class EnumerationFile;
+template<class I> class PathTable;
+
+template<class I>
+class TripletSearch
+{
+public:
+	// search params
+	Triplet<I> m_target;
+	float m_targetRadius;
+    unsigned int m_maxDepth = 10;
+	unsigned int m_maxHeight;
+	unsigned int m_nMaxTriangleSum = 1000;
+	unsigned int m_maxNumEnumerationResults;
+	TripletTriangle<I> m_clip;
+	string m_operations;
+
+	GrowthEnum m_growth = GrowthEnum::STOCHASTIC;
+
+	// findAll(): expand each (triangle, remaining depth) once and share its subtree; see findAllTable().
+	// with m_bListPaths off, only the path DAG is kept, and m_paths is left empty
+	bool m_bFindAllTable = true;
+	bool m_bListPaths = true;
+	//static std::map<GrowthEnum, string> s_growth_enum_names;
+
+	// use the original recursive traversals instead of the explicit-stack engine.
+	// results and counters are identical; kept for comparison
+	bool m_bRecursive = false;
+
+	// search(): once the search collapses to an edge, finish with searchEdge()'s Stern-Brocot
+	// runs instead of visiting each 'r'/'l' node. verbose searches keep the per-node trace
+	bool m_bEdgeJump = true;
+
+	// enumerate(): walk only the x <= y <= z sextant and emit the other 5 by permutation; see enumerateSymmetric().
+	// used only with the basis clip triangle, and not with m_bRecursive
+	bool m_bEnumerateSymmetric = false;
+
+	// enumerate(): when set, progress is saved to this file every m_checkpointSeconds, and each triplet
+	// found is logged to <file>.log. With m_bResume, an interrupted enumerate() continues from its last
+	// checkpoint; see enumerateCheckpointed(). Not with m_bRecursive, and m_bEnumerateSymmetric is ignored
+	string m_checkpointFile;
+	double m_checkpointSeconds = 60;
+	bool m_bResume = false;
+
+	// search(): when set, targets up to the table's height are looked up rather than searched
+	const PathTable<I> *m_pPathTable = nullptr;
+
+	// search results
+	vector<string> m_paths;
+	vector<string> m_batchPaths;	// searchBatch(): one path per target, in input order
+	string m_bestPath;
+	int m_countMaxDepth;
+	int m_countMaxHeight;
+	int m_countMaxSum = 0;
+	int m_countCollision = 0;
+	int m_countDeadEnds;
+	bool m_bVerbose;
+
+	// enumeration results
+	std::map<Triplet<I>, string> m_enumeration;
+
+	// when set, every new enumeration entry is also appended here in discovery order
+	vector<std::pair<Triplet<I>, string>> *m_pEnumerationLog = nullptr;
+
+	// streaming enumeration: called once per new triplet, in discovery order.
+	// path + suffix is the entry's path, as written to the CSV
+	typedef std::function<void(const Triplet<I> &triplet, const TripletPath &path, const char *suffix, unsigned int depth)> EnumerationCallback;
+
+	TripletSearch() 
+	{
+		m_targetRadius = 0;
+		m_maxDepth = 18;
+		m_maxHeight = 0x00010000;
+		m_maxNumEnumerationResults = 100000;
+		m_operations = "xyzXYZ123";// "468";// "456789";// "xyzXYZ";
+		m_bVerbose = true;
+	}
+
+	bool findAll(const Triplet<I> &target)
+	{
+		m_target = target;
+		m_paths.clear();
+		m_bestPath.clear();
+		m_countMaxDepth = 0;
+		m_countMaxHeight = 0;
+		m_countDeadEnds = 0;
+
+		//cout << "--- Searching for " << m_target << " Ops: " << m_operations << " Depth: " << m_maxDepth << endl;
+
+		m_findAllNodes.clear();
+
+		TripletTriangle<I> m;
+		if(m_bFindAllTable)
+		{
+			return findAllTable(m);
+		}
+		else if(m_bRecursive)
+		{
+			findAllR(m, 0);
+		}
+		else
+		{
+			traverse(m, [this](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) {
+				return findAllVisit(triangle, path, depth);
+			});
+		}
+
+		//cout << "" << m_paths.size() << " paths. Maxdepth: " << m_countMaxDepth << " Deadends: " << m_countDeadEnds << endl;
+		return (m_paths.size() > 0);
+	}
+
+	//
+	//	findAll() path DAG
+	//	Different op sequences often reach the same triangle, most often through ops that leave a
+	//	collapsed triangle unchanged. What lies below a triangle depends only on its columns and the
+	//	depth left, so a transposition table on those expands each one once. The results form a DAG:
+	//	a node is either a found target (terminal), or has edges to the children that lead to one.
+	//	Every root-to-terminal walk is a distinct path, listed in the same order as the tree walk.
+	//	Keying on the depth left keeps the graph acyclic, as an op can return its own triangle.
+	//
+	struct FindAllNode
+	{
+		const char *terminal = nullptr;						// "-ctr", "-p01", .. if the target is found here
+		vector<std::pair<char, unsigned int>> children;		// op, node; only children that lead to the target
+	};
+
+	// nodes of the last findAll(); the root is the last node
+	vector<FindAllNode> m_findAllNodes;
+
+	// number of distinct paths in the last findAll(), counted on the DAG without listing them
+	unsigned long long countFindAllPaths() const
+	{
+		vector<unsigned long long> counts(m_findAllNodes.size());
+		for(size_t i = 0; i < m_findAllNodes.size(); ++i) {
+			// children are always added before their parents
+			const FindAllNode &node = m_findAllNodes[i];
+			counts[i] = node.terminal ? 1 : 0;
+			for(auto &child : node.children) {
+				counts[i] += counts[child.second];
+			}
+		}
+		return counts.empty() ? 0 : counts.back();
+	}
+
+private:
+	struct FindAllKey
+	{
+		Triplet<I> m[3];
+		unsigned int remaining;
+
+		bool operator==(const FindAllKey &rhs) const
+		{
+			return remaining == rhs.remaining && m[0] == rhs.m[0] && m[1] == rhs.m[1] && m[2] == rhs.m[2];
+		}
+	};
+
+	struct FindAllKeyHash
+	{
+		size_t operator()(const FindAllKey &key) const
+		{
+			size_t h = key.remaining;
+			for(int i = 0; i < 3; ++i) {
+				h = h * 0x9e3779b97f4a7c15ull + TripletHashSet<I>::hash(key.m[i]);
+			}
+			return h;
+		}
+	};
+
+	std::unordered_map<FindAllKey, unsigned int, FindAllKeyHash> m_findAllTable;
+	string m_findAllOps;
+
+	bool findAllTable(const TripletTriangle<I> &root)
+	{
+		m_findAllNodes.clear();
+		m_findAllTable.clear();
+
+		// each valid op once; a repeated op would only repeat its subtree's paths
+		m_findAllOps.clear();
+		for(char op : m_operations) {
+			if(TripletPath::opCode(op) >= 0 && m_findAllOps.find(op) == string::npos) {
+				m_findAllOps += op;
+			}
+		}
+
+		unsigned int index = findAllExpand(root, 0);
+		m_findAllTable.clear();
+
+		if(m_bListPaths) {
+			TripletPath path;
+			findAllList(index, path);
+		}
+
+		const FindAllNode &node = m_findAllNodes[index];
+		return node.terminal || !node.children.empty();
+	}
+
+	// builds the DAG node for a triangle at depth, or returns the one already built
+	unsigned int findAllExpand(const TripletTriangle<I> &triangle, unsigned int depth)
+	{
+		FindAllKey key = { { triangle[0], triangle[1], triangle[2] }, m_maxDepth - depth };
+		auto found = m_findAllTable.find(key);
+		if(found != m_findAllTable.end()) {
+			return found->second;
+		}
+
+		FindAllNode node;
+		node.terminal = findAllTerminal(triangle);
+		if(!node.terminal)
+		{
+			if(depth >= m_maxDepth) {
+				++m_countMaxDepth;
+			}
+			else if(!triangle.centroid().precedes(m_target)) {
+				++m_countDeadEnds;
+			}
+			else {
+				for(char op : m_findAllOps) {
+					TripletTriangle<I> child;
+					child.set(triangle[0], triangle[1], triangle[2]);
+					child.depth = triangle.depth;
+					child.apply(op);
+
+					unsigned int index = findAllExpand(child, depth + 1);
+					const FindAllNode &childNode = m_findAllNodes[index];
+					if(childNode.terminal || !childNode.children.empty()) {
+						node.children.push_back({ op, index });
+					}
+				}
+			}
+		}
+
+		m_findAllNodes.push_back(std::move(node));
+		unsigned int index = (unsigned int)m_findAllNodes.size() - 1;
+		m_findAllTable[key] = index;
+		return index;
+	}
+
+	// lists every path in the DAG below node, depth-first in op order
+	void findAllList(unsigned int index, TripletPath &path)
+	{
+		const FindAllNode &node = m_findAllNodes[index];
+		if(node.terminal)
+		{
+			m_paths.push_back(path.str() + node.terminal);
+			if(m_bVerbose) {
+				cout << "Found path: [" << m_paths.back() << "]\n";
+			}
+			return;
+		}
+
+		for(auto &child : node.children) {
+			path.push_back(child.first);
+			findAllList(child.second, path);
+			path.pop_back();
+		}
+	}
+
+	// the suffix naming where the target lies in this triangle, or null if it is not its centroid or a midpoint
+	const char *findAllTerminal(const TripletTriangle<I> &triangle) const
+	{
+		if(triangle.centroid() == m_target) return "-ctr";
+		if(triangle[0] + triangle[1] == m_target) return "-p01";
+		if(triangle[1] + triangle[2] == m_target) return "-p12";
+		if(triangle[0] + triangle[2] == m_target) return "-p02";
+		return nullptr;
+	}
+
+	bool findAllR(const TripletTriangle<I>& triangle, unsigned int depth) 
+	{
+		const char *ops = findAllVisit(triangle, triangle.path, depth);
+		for(; ops && *ops; ++ops) {
+			findAllR(triangle + *ops, depth + 1);
+		}
+		return false;
+	}
+
+	// findAll() step: records paths ending at this triangle, and returns the ops to expand
+	const char *findAllVisit(const TripletTriangle<I>& triangle, const TripletPath &path, unsigned int depth)
+	{
+		Triplet<I> ctr = triangle.centroid();
+		assert(ctr.isCoprime());
+		if(ctr == m_target) 
+		{
+			string found = path.str() + "-ctr";
+			if(std::find(m_paths.begin(), m_paths.end(), found) == m_paths.end()) 
+			{
+				m_paths.push_back(found);
+				if(m_bVerbose) {
+					cout << "Found path: [" << found << "]\n";
+				}
+			}
+			return nullptr;
+		}
+
+		// compute the triangle edge midpoints
+		Triplet<I> p01 = triangle[0] + triangle[1];
+		Triplet<I> p12 = triangle[1] + triangle[2];
+		Triplet<I> p02 = triangle[0] + triangle[2];
+
+		// is this step necessary? seems that every triple should eventually be a vertex..
+		if(p01 == m_target) { m_paths.push_back(path.str() + "-p01"); return nullptr; }
+		if(p12 == m_target) { m_paths.push_back(path.str() + "-p12"); return nullptr; }
+		if(p02 == m_target) { m_paths.push_back(path.str() + "-p02"); return nullptr; }
+
+		if(depth >= m_maxDepth) {
+			++m_countMaxDepth;
+			return nullptr;
+		}
+
+		if(!ctr.precedes(m_target)) {
+			++m_countDeadEnds;
+			return nullptr;
+		}
+
+		return m_operations.c_str();
+	}
+
+public:
+	const int ERROR_INTERNAL = -9;
+
+	// sextant tree search. each recursion drills down into 1/6 of the parent search area.
+    // Uses sextant cascade operators (xyzXYZ) and dimensional collapse (123). ignores m_operations.
+	int search(const Triplet<I> &target)
+	{
+		m_target = target;
+		m_paths.clear();
+		m_bestPath.clear();
+		m_countMaxDepth = 0;
+		m_countMaxHeight = 0;
+		m_countDeadEnds = 0;
+
+		// the table holds search()'s paths; deeper than m_maxDepth, search() would have given up
+		string path;
+		unsigned int ops = 0;
+		if(m_pPathTable && !m_bVerbose && m_pPathTable->lookup(target, path, ops) && ops <= m_maxDepth) {
+			m_paths.push_back(path);
+			return 1;
+		}
+
+		if(m_bVerbose) 
+		{
+			cout << "--- Sextant search --- Target: " << m_target 
+				<< " Growth: " << GrowthEnumString(m_growth) 
+				<< " Depth: " << m_maxDepth << " ---\n";
+		}
+
+		TripletTriangle<I> m;
+		if(m_bRecursive)
+		{
+			searchR(m, 0);
+		}
+		else
+		{
+			traverse(m, [this](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) {
+				return searchVisit(triangle, path, depth);
+			});
+		}
+
+		//cout << endl;
+		std::sort(m_paths.begin(), m_paths.end());
+		return (m_paths.size() > 0);
+	}
+
+	//
+	//	Batch search
+	//	Resolves many targets in one walk. Targets that take the same op descend together, so each node
+	//	is built once and its classifying planes are computed once for all the targets that reach it.
+	//	At each node the targets are partitioned by the op their sextant selects, and a target drops out
+	//	as soon as its search ends. Paths are the same as search()'s; m_batchPaths holds them in input
+	//	order, with an empty string for a target that was not found within m_maxDepth.
+	//
+	static const size_t BATCH_MIN_SHARED = 4;	// fewer targets than this are cheaper to classify one by one
+
+	bool searchBatch(const Triplet<I> *targets, size_t count)
+	{
+		m_paths.clear();
+		m_bestPath.clear();
+		m_batchPaths.assign(count, string());
+		m_countMaxDepth = 0;
+		m_countMaxHeight = 0;
+		m_countDeadEnds = 0;
+
+		// frames hold the node's op, not its path; the one path is cut back and extended as frames pop
+		struct BatchFrame
+		{
+			Triplet<I> m[3];
+			unsigned int triDepth;
+			unsigned int depth;
+			unsigned int parentNibbles;
+			char op;
+			size_t begin, end;		// range of order[] reaching this node
+		};
+
+		// ops searchVisit() can take, in the order children are walked
+		static const char batchOps[] = "xyzXYZ123rl";
+		const size_t numOps = sizeof(batchOps) - 1;
+
+		vector<size_t> order(count), sorted(count);
+		vector<unsigned char> opIndex(count);
+		std::iota(order.begin(), order.end(), 0);
+
+		vector<BatchFrame> stack;
+		TripletTriangle<I> node;
+		TripletPath path;
+		stack.push_back({ { node[0], node[1], node[2] }, 0, 0, 0, 0, 0, count });
+		size_t numFound = 0;
+
+		while(!stack.empty())
+		{
+			BatchFrame f = stack.back();
+			stack.pop_back();
+			node.set(f.m[0], f.m[1], f.m[2]);
+			node.depth = f.triDepth;
+			path.truncate(f.parentNibbles);
+			if(f.op) path.push_back(f.op);
+
+			// a lone target has nothing to share; finish it with the single-target walk
+			if(f.end - f.begin == 1) {
+				size_t target = order[f.begin];
+				m_target = targets[target];
+				traverse(node, [this](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) {
+					return searchVisit(triangle, path, depth);
+				}, f.depth, &path);
+				if(!m_paths.empty()) {
+					m_batchPaths[target] = std::move(m_paths.back());
+					m_paths.clear();
+					++numFound;
+				}
+				continue;
+			}
+
+			typename TripletTriangle<I>::PointClassifier planes;
+			const typename TripletTriangle<I>::PointClassifier *classifier = nullptr;
+			if(f.end - f.begin >= BATCH_MIN_SHARED && node.numColumns() >= 2) {
+				planes = typename TripletTriangle<I>::PointClassifier(node);
+				classifier = &planes;
+			}
+
+			size_t opCounts[numOps + 1] = {};
+			for(size_t i = f.begin; i < f.end; ++i) {
+				size_t target = order[i];
+				m_target = targets[target];
+				const char *ops = searchVisit(node, path, f.depth, classifier);
+
+				// done: keep the path, if any
+				if(!ops || !*ops) {
+					opIndex[target] = (unsigned char)numOps;
+					if(!m_paths.empty()) {
+						m_batchPaths[target] = std::move(m_paths.back());
+						m_paths.clear();
+						++numFound;
+					}
+					continue;
+				}
+
+				opIndex[target] = (unsigned char)(strchr(batchOps, *ops) - batchOps);
+				assert(opIndex[target] < numOps);
+				++opCounts[opIndex[target]];
+			}
+
+			// group the remaining targets by op, keeping their order within each group
+			size_t starts[numOps + 1];
+			starts[0] = f.begin;
+			for(size_t k = 0; k < numOps; ++k) {
+				starts[k + 1] = starts[k] + opCounts[k];
+			}
+			size_t next[numOps];
+			std::copy(starts, starts + numOps, next);
+			for(size_t i = f.begin; i < f.end; ++i) {
+				unsigned char k = opIndex[order[i]];
+				if(k < numOps) sorted[next[k]++] = order[i];
+			}
+			std::copy(sorted.begin() + f.begin, sorted.begin() + starts[numOps], order.begin() + f.begin);
+
+			// push in reverse, so the children are walked in op order
+			for(size_t k = numOps; k-- > 0; ) {
+				if(!opCounts[k]) continue;
+
+				TripletTriangle<I> child;
+				child.set(node[0], node[1], node[2]);
+				child.depth = node.depth;
+				child.apply(batchOps[k]);
+				stack.push_back({ { child[0], child[1], child[2] }, child.depth, f.depth + 1, path.nibbles(), batchOps[k], starts[k], starts[k + 1] });
+			}
+		}
+
+		return numFound == count;
+	}
+
+	bool searchBatch(const vector<Triplet<I>> &targets)
+	{
+		return searchBatch(targets.data(), targets.size());
+	}
+
+private:
+	int searchR(const TripletTriangle<I> &triangle, unsigned int depth) 
+	{
+		size_t numPaths = m_paths.size();
+		const char *ops = searchVisit(triangle, triangle.path, depth);
+		for(; ops && *ops; ++ops) {
+			searchR(triangle + *ops, depth + 1);
+		}
+		return (int)(m_paths.size() - numPaths);
+	}
+
+	// search() step: classifies the target against this triangle's sextants,
+	// and returns the single op that descends toward it, or null if the search ends here.
+	// classifier, if given, holds the triangle's planes precomputed
+	const char *searchVisit(const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth,
+		const typename TripletTriangle<I>::PointClassifier *classifier = nullptr)
+	{
+		if(triangle.isZero())
+		{
+			return nullptr;
+		}
+
+		Triplet<I> ctr = triangle.centroid();
+		assert(ctr.isCoprime());
+		//if(!(ctr.isCoprime())) {
+		//	cerr << "\n -- TEST FAILED: \n" << triangle << endl;
+		//	return ERROR_INTERNAL;
+		//}
+
+		if(!(classifier ? classifier->containsPoint(m_target) : triangle.containsPoint(m_target))) 
+		{
+			cerr << ".. Rejecting[" << depth << "]..\n";
+			cerr << triangle;
+			return nullptr;
+		}
+
+		if( !triangle[0].precedes(m_target) &&
+			!triangle[1].precedes(m_target) &&
+			!triangle[2].precedes(m_target)) 
+		{
+			cerr << " ** wrong turn somewhere. no vertex precedes " << m_target << endl;
+			cerr << triangle;
+			return nullptr;
+		}
+
+		if(	   ctr.x > m_target.x
+			|| ctr.y > m_target.y
+			|| ctr.z > m_target.z)
+		{
+			cerr << " ** missed the exit somewhere. ctr=" << ctr << " > target=" << m_target << endl;
+			cerr << triangle;
+			return nullptr;
+		}
+
+		//if(m_bVerbose)
+		//{
+		//	cout << ".. Searching[" << depth << "].. " << path << "\n";
+		//	cout << triangle;
+		//}
+
+		//bool found = false;		
+
+		/* // method 1		
+		// check vertices?
+		if(triangle[0] == m_target) { found = true; m_paths.push_back(path + "-vX"); return nullptr; }
+		if(triangle[1] == m_target) { found = true; m_paths.push_back(path + "-vY"); return nullptr; }
+		if(triangle[2] == m_target) { found = true; m_paths.push_back(path + "-vZ"); return nullptr; }
+
+		//// compute the triangle edge midpoints
+		//Triplet<I> p01 = triangle[0] + triangle[1];
+		//Triplet<I> p12 = triangle[1] + triangle[2];
+		//Triplet<I> p02 = triangle[0] + triangle[2];
+
+		//if(p01 == m_target) { found = true; m_paths.push_back(path + "-p01"); }
+		//if(p12 == m_target) { found = true; m_paths.push_back(path + "-p12"); }
+		//if(p02 == m_target) { found = true; m_paths.push_back(path + "-p02"); }
+*/
+
+		SexClass sextant = classifier ? classifier->getSextant(m_target) : triangle.getSextant(m_target);
+
+		if(m_bVerbose)
+		{
+			cout << "Sextant: " << sextant.asChar << endl;
+		}
+
+		// method 2
+		if(triangle.numColumns() == 1)
+		{
+			if(ctr == m_target)
+			{
+				//found = true;
+				if(m_bVerbose)
+					cout << "FOUND: " << path << "." << endl;
+
+				m_paths.push_back(path.str() + ".");
+				return nullptr;
+			}
+
+			cerr << " ** unknown error. single column miss" << endl;
+			cerr << triangle;
+			return nullptr;
+		}
+
+		// method 1
+
+        //  if target is found, skip the dimensional collapses
+		if(sextant.asInt == SEX00) 
+        {
+			m_paths.push_back(path.str() + "!");
+			return nullptr;
+		}//*/
+
+
+		//if(!found)
+		{
+			if(depth >= m_maxDepth) 
+			{
+				++m_countMaxDepth;
+				m_bestPath = (path.str() + "...");
+				return nullptr;
+			}
+
+			/*
+			// build 6 subregions, characterize point: deprecate
+			TripletTriangle<I> mx('x', triangle); int inmx = mx.containsPoint(m_target);
+			TripletTriangle<I> my('y', triangle); int inmy = my.containsPoint(m_target);
+			TripletTriangle<I> mz('z', triangle); int inmz = mz.containsPoint(m_target);
+			TripletTriangle<I> mX('X', triangle); int inmX = mX.containsPoint(m_target);
+			TripletTriangle<I> mY('Y', triangle); int inmY = mY.containsPoint(m_target);
+			TripletTriangle<I> mZ('Z', triangle); int inmZ = mZ.containsPoint(m_target);
+			int regionCount = inmx + inmy + inmz + inmX + inmY + inmZ;
+			*/
+
+			/*
+			//	METHOD ONE
+			// note that mirror symmetry is broken here, to avoid duplicate paths to edge points:
+			// points on edges (other than the centroid) are resolved to neighboring regions in a
+			// counterclockwise fashion.
+			// points on the X median nearer to X, for example, are resolved 
+			// as if the edge is part of the X- region;
+			// points on the X median nearer the YZ edge are resolved as if in the Z+ region.
+			// This breaks mirror symmetry but preserves a sort of rotational symmetry.
+			// Not sure how else this could be resolved: 
+			// - accept that there would be up to 2 paths to a triplet?
+			// - on reaching a median, collapse to 2 points--exclude one of the other vertices 
+			//   from all further calculations. this reduces to a modified rational tree traversal.
+
+			if(sextant == SEXX0 || sextant == SEXXN)
+			{
+				foundCount += searchR(TripletTriangle<I>('x', triangle), path + 'x', depth + 1);
+			}
+			else if(sextant == SEXXY || sextant == SEXYP)
+			{
+				foundCount += searchR(TripletTriangle<I>('Y', triangle), path + 'Y', depth + 1);
+			}
+			else if(sextant == SEXY0 || sextant == SEXYN)
+			{
+				foundCount += searchR(TripletTriangle<I>('y', triangle), path + 'y', depth + 1);
+			}
+			else if(sextant == SEXYZ || sextant == SEXZP)
+			{
+				foundCount += searchR(TripletTriangle<I>('Z', triangle), path + 'Z', depth + 1);
+			}
+			else if(sextant == SEXZ0 || sextant == SEXZN)
+			{
+				foundCount += searchR(TripletTriangle<I>('z', triangle), path + 'z', depth + 1);
+			}
+			else if(sextant == SEXZX || sextant == SEXXP)
+			{
+				foundCount += searchR(TripletTriangle<I>('X', triangle), path + 'X', depth + 1);
+			}
+			else
+			{
+				cerr << "!!??\n";
+			}
+			//*/
+
+			//	METHOD TWO
+
+
+            //  2D
+            if (triangle.numColumns() == 2)
+            {
+                if (m_bEdgeJump && !m_bVerbose && searchEdge(triangle, path, depth))
+                    return nullptr;
+
+                // 3 possibilities: x-ward, y-ward, or 0 (target found)
+                if (sextant == SEXX0) 	// on line between X and ctr
+                    return "r";
+                else if (sextant == SEXY0)	// on line between Y and ctr
+                    return "l";
+                else if (sextant == SEX00)
+                    return "1";
+                else
+                    throw(std::exception("Invalid 2D sextant result"));
+            }
+
+            // 3 column
+            if (sextant == SEX00)
+            {
+                m_paths.push_back(path.str() + "-ctr");
+                return nullptr;
+            }
+            else if(sextant == SEXXN)
+				return "x";
+			else if(sextant == SEXYP)
+				return "Y";
+			else if(sextant == SEXYN)
+				return "y";
+			else if(sextant == SEXZP)
+				return "Z";
+			else if(sextant == SEXZN)
+				return "z";
+			else if(sextant == SEXXP)
+				return "X";
+			else if(sextant == SEXX0) 	// on line between X and ctr: merge YZ, then toward X
+				return "2";
+			else if(sextant == SEXYZ) 	// on line between ctr and YZ's midpoint: merge YZ, then toward Y
+				return "2";
+			else if(sextant == SEXY0)	// on line between Y and ctr: merge XZ->X, then toward Y
+				return "3";
+			else if(sextant == SEXZX)	// on line between ctr and XZ's midpoint: merge XZ->X, then toward X
+				return "3";
+			else if(sextant == SEXZ0)	// on line between Z and ctr: merge XY->X, then toward Y (formerly Z)
+				return "1";
+			else if(sextant == SEXXY)	// on line between ctr and XY's midpoint: merge XY->X, then toward X
+				return "1";
+			else
+			{
+				cerr << "!!??\n";
+			}
+		}
+
+		return nullptr;
+	}
+
+	//
+	//	2D continuation for search(): finishes the search on a collapsed triangle in one pass.
+	//	On the edge, target = a*X + b*Y. Each 'r' takes (a, b) to (a - b, b) and each 'l' takes it
+	//	to (a, b - a), until a == b at the centroid, so a run of k equal steps is one division, as
+	//	in a continued fraction. The runs are spelled out into the usual path, and depth limits,
+	//	m_bestPath and m_countMaxDepth come out as they would node by node.
+	//	Returns false, leaving the node to searchVisit(), if the target isn't strictly inside the edge.
+	//
+	bool searchEdge(const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth)
+	{
+		I a, b;
+		if(!edgeCoordinates(triangle, m_target, a, b) || a < 1 || b < 1)
+		{
+			return false;
+		}
+
+		string result = path.str();
+		for(;;)
+		{
+			if(a == b)
+			{
+				m_paths.push_back(result + "!");
+				return true;
+			}
+			if(depth >= m_maxDepth)
+			{
+				++m_countMaxDepth;
+				m_bestPath = result + "...";
+				return true;
+			}
+
+			// steps until the larger coordinate is no longer larger, capped by the depth left
+			I &larger = (a > b) ? a : b;
+			I smaller = (a > b) ? b : a;
+			I k = (std::min)((larger - 1) / smaller, (I)(m_maxDepth - depth));
+			result.append((size_t)k, (a > b) ? 'r' : 'l');
+			larger -= k * smaller;
+			depth += (unsigned int)k;
+		}
+	}
+
+	//	target = a*tri[0] + b*tri[1] for a 2-column triangle with nonnegative columns, packed left.
+	//	false if there are no such integers
+	static bool edgeCoordinates(const TripletTriangle<I> &tri, const Triplet<I> &target, I &a, I &b)
+	{
+		typedef typename Wide<I>::type W;
+		const Triplet<I> &x = tri[0], &y = tri[1];
+		if(!x || !y || !!tri[2] || x.x < 0 || x.y < 0 || x.z < 0 || y.x < 0 || y.y < 0 || y.z < 0)
+		{
+			return false;
+		}
+
+		// Cramer's rule on the largest component of x cross y
+		const I *px = &x.x, *py = &y.x, *pt = &target.x;
+		W n = 0, na = 0, nb = 0;
+		for(int k = 0; k < 3; ++k)
+		{
+			int i = (k + 1) % 3, j = (k + 2) % 3;
+			W c = (W)px[i] * py[j] - (W)px[j] * py[i];
+			if(magnitude(c) > magnitude(n))
+			{
+				n = c;
+				na = (W)pt[i] * py[j] - (W)pt[j] * py[i];
+				nb = (W)px[i] * pt[j] - (W)px[j] * pt[i];
+			}
+		}
+		if(!n || na % n || nb % n)
+		{
+			return false;
+		}
+
+		W wa = na / n, wb = nb / n;
+		for(int k = 0; k < 3; ++k)
+		{
+			if(wa * px[k] + wb * py[k] != pt[k]) return false;
+		}
+		a = (I)wa;
+		b = (I)wb;
+		return true;
+	}
+
+public:
+
+	//
+	//	Run-length ("jump") sextant search.
+	//	Follows the same descent as search(), but each step applies a whole run of
+	//	identical operators at once, the way Euclid's algorithm replaces repeated
+	//	subtraction with a division.
+	//
+	//	The target is tracked by its integer coordinates in the current triangle's basis:
+	//	target = c[0]*m[0] + c[1]*m[1] + c[2]*m[2]. Since det == 1, the sextant tests
+	//	reduce to comparisons between the coordinates, and each operator is a subtraction.
+	//
+	//	Result paths are run-length encoded: an op followed by a repeat count, e.g. "{YZ}r999!".
+	//	Use expandPath() to recover the path search() would return.
+	//	m_maxDepth limits the number of runs, not the expanded path length.
+	//
+	int searchJump(const Triplet<I> &target)
+	{
+		m_target = target;
+		m_paths.clear();
+		m_bestPath.clear();
+		m_countMaxDepth = 0;
+		m_countMaxHeight = 0;
+		m_countDeadEnds = 0;
+
+		if(m_bVerbose)
+		{
+			cout << "--- Jump search --- Target: " << m_target
+				<< " Depth: " << m_maxDepth << " ---\n";
+		}
+
+		// coordinates of the target in the basis triangle are the target itself
+		TripletTriangle<I> triangle;
+		I c[3] = { target.x, target.y, target.z };
+		string path;
+
+		// merge3 operator chars, indexed by [primary][secondary]
+		static const char merge3ops[3][3] = {
+			{ 0, 'x', 'X' },
+			{ 'Y', 0, 'y' },
+			{ 'z', 'Z', 0 } };
+
+		for(unsigned int depth = 0; ; ++depth)
+		{
+			bool collapsed = !triangle[2];
+
+			if(c[0] == c[1] && (collapsed || c[1] == c[2]))
+			{
+				// target is the centroid
+				m_paths.push_back(path + "!");
+				return 1;
+			}
+
+			if(depth >= m_maxDepth)
+			{
+				++m_countMaxDepth;
+				m_bestPath = path + "...";
+				return 0;
+			}
+
+			if(collapsed)
+			{
+				// 2D: Stern-Brocot steps toward the larger coordinate
+				int from = (c[0] > c[1]) ? 0 : 1;
+				int to = 1 - from;
+				if(!c[to])
+				{
+					// target is a vertex, never reached as a centroid
+					++m_countMaxDepth;
+					m_bestPath = path + "...";
+					return 0;
+				}
+
+				I k = (c[from] - 1) / c[to];
+				triangle.mergeRun(from, to, k);
+				c[from] -= k * c[to];
+				appendRun(path, from ? 'l' : 'r', k);
+				continue;
+			}
+
+			// 3D: target on a median collapses to the edge through it
+			if(c[1] == c[2])
+			{
+				triangle.collapse(1, 2);
+				c[2] = 0;
+				path += "{YZ}";
+				continue;
+			}
+			if(c[2] == c[0])
+			{
+				triangle.collapse(2, 0);
+				c[2] = 0;
+				path += "{ZX}";
+				continue;
+			}
+			if(c[0] == c[1])
+			{
+				triangle.collapse(0, 1);
+				c[1] = c[2];
+				c[2] = 0;
+				path += "{XY}";
+				continue;
+			}
+
+			// 3D interior: cascade merge primary -> secondary, where c[p] > c[s] > c[t]
+			int p = 0;
+			for(int i = 1; i < 3; ++i)
+				if(c[i] > c[p]) p = i;
+			int s = (p + 1) % 3, t = (p + 2) % 3;
+			if(c[t] > c[s]) std::swap(s, t);
+
+			I k = merge3RunLength(c[p], c[s], c[t]);
+			triangle.merge3Run(p, s, k);
+			typedef typename Wide<I>::type W;
+			c[p] = (I)((W)c[p] - (W)k * c[s] + (W)c[t] * ((W)k * (k - 1) / 2));
+			c[s] -= k * c[t];
+			appendRun(path, merge3ops[p][s], k);
+		}
+	}
+
+	//	expands a run-length encoded path from searchJump(): "x3{YZ}r2!" -> "xxx{YZ}rr!"
+	static string expandPath(const string &rlePath)
+	{
+		string path;
+		for(size_t i = 0; i < rlePath.size(); )
+		{
+			char op = rlePath[i++];
+			size_t count = 0;
+			while(i < rlePath.size() && rlePath[i] >= '0' && rlePath[i] <= '9')
+			{
+				count = 10 * count + (rlePath[i++] - '0');
+			}
+			path.append(count ? count : 1, op);
+		}
+		return path;
+	}
+
+private:
+	static void appendRun(string &path, char op, I k)
+	{
+		path += op;
+		if(k > 1)
+		{
+			path += std::to_string((long long)k);
+		}
+	}
+
+	//	number of consecutive merge3(p,s) steps taken while the target stays
+	//	in the (p,s) sextant, given coordinates cp > cs > ct.
+	//	after j steps: cs(j) = cs - j*ct, cp(j) = cp - j*cs + ct*j(j-1)/2.
+	//	both cs(j) - ct and cp(j) - cs(j) decrease with j, so the run is a prefix
+	//	and its length can be found by bisection.
+	static I merge3RunLength(I cp, I cs, I ct)
+	{
+		typedef typename Wide<I>::type W;
+		assert(cp > cs && cs > ct && ct >= 0);
+
+		// steps while cs(j) > ct
+		W hi = ct ? (W)(cs - 1) / ct : (W)(cp - 1) / cs;
+
+		// steps while cp(j) > cs(j): d(j) = cp - cs*(j+1) + ct*j(j+1)/2 > 0
+		auto inside = [&](W j) {
+			return (W)cp - (W)cs * (j + 1) + (W)ct * (j * (j + 1) / 2) > 0;
+		};
+
+		W lo = 1;
+		while(lo < hi)
+		{
+			W mid = lo + (hi - lo + 1) / 2;
+			if(inside(mid - 1))
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+		return (I)lo;
+	}
+
+public:
+
+	void dumpSearchResults() const {
+		if(m_paths.size() == 1) {
+			cout << "Path to " << m_target << ": " << m_paths[0] << endl;
+		}
+		else if(m_paths.size() > 1) {
+			cout << " MULTIPLE PATHS!!" << endl;
+			for(unsigned int i = 0; i < m_paths.size(); ++i) {
+				cout << m_paths[i] << ", ";
+			}
+			cout << endl;
+		}
+		else {
+			cout << m_target << ": **** NO PATHS FOUND at depth " << m_maxDepth << " ****\n";
+		}
+	}
+
+	//
+	//	Traversal / Enumeration
+	//
+
+	// streams each new triplet to onTriplet as it is found, instead of collecting CSV rows in m_enumeration.
+	// only the triplets seen so far are kept, for dedup and the result limit
+	bool enumerate(EnumerationCallback onTriplet) {
+		m_onTriplet = onTriplet;
+		bool result = enumerate();
+		m_onTriplet = nullptr;
+		return result;
+	}
+
+	// appends each new triplet to a structure-of-arrays block, in discovery order
+	bool enumerate(TripletBlock<I> &block) {
+		return enumerate([&](const Triplet<I> &p, const TripletPath &, const char *, unsigned int) {
+			block.push_back(p);
+		});
+	}
+
+	bool enumerate() {
+
+		assert(m_maxDepth >= 0 && m_maxDepth < 1000);
+		assert(m_maxHeight > 1);
+		//assert(m_clip.isCoprime());
+		assert(m_clip.isTriangle());
+
+		cerr << "Enumerating depth: " << m_maxDepth << " max height: " << m_maxHeight
+			<< " max results: " << m_maxNumEnumerationResults
+			<< "\nClip triangle:\n" << m_clip;
+
+		m_enumeration.clear();
+		m_visited.clear();
+		m_clipInsideDepth = CLIP_NOT_INSIDE;
+		m_countMaxDepth = 0;
+		m_countMaxHeight = 0;
+		m_countDeadEnds = 0;
+		if(!m_checkpointFile.empty() && !m_bRecursive) {
+			bool result = enumerateCheckpointed();
+			m_visited.clear();
+			return result;
+		}
+		TripletTriangle<I> m;
+
+		// enumerate the 3 parent vertices
+		enumerateCheck(m[0], m.path, "-P0", 0);
+		enumerateCheck(m[1], m.path, "-P1", 0);
+		enumerateCheck(m[2], m.path, "-P2", 0);
+
+		// enumerate all descendent vertices
+		if(m_bEnumerateSymmetric && !m_bRecursive && isBasisClip())
+		{
+			enumerateSymmetric(m);
+		}
+		else if(m_bRecursive)
+		{
+			enumerateR(m, 0);
+		}
+		else
+		{
+			traverse(m, [this](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) {
+				return enumerateVisit(triangle, path, depth);
+			});
+		}
+
+		m_visited.clear();
+		return true;
+	}
+
+	//
+	//	Sharded enumerate()
+	//	Enumerates subtrees [first, last) of the 6^splitDepth at splitDepth, numbered as by
+	//	TripletPath::rank(), so independent processes can each take a shard. A node above the split
+	//	belongs to the shard of its first subtree, the one it precedes in pre-order, and the root's
+	//	vertices go with subtree 0. Ancestors owned by an earlier shard are walked through without
+	//	being enumerated.
+	//
+	//	Dedup is per shard, so a triplet shared by neighbouring shards is found by both. Merging the
+	//	shards in order and keeping each triplet's first row gives exactly enumerate()'s results,
+	//	and the shards' counters add up to its counters, unless a shard reaches the result limit.
+	//
+	bool enumerate(unsigned int splitDepth, unsigned long long first, unsigned long long last) {
+
+		assert(m_maxDepth < 1000);
+		assert(m_maxHeight > 1);
+		assert(m_clip.isTriangle());
+		assert(first <= last && last <= TripletPath::rankCount(splitDepth));
+
+		cerr << "Enumerating depth: " << m_maxDepth << " max height: " << m_maxHeight
+			<< " max results: " << m_maxNumEnumerationResults
+			<< " subtrees: [" << first << ", " << last << ") of " << TripletPath::rankCount(splitDepth)
+			<< " at depth " << splitDepth
+			<< "\nClip triangle:\n" << m_clip;
+
+		m_enumeration.clear();
+		m_visited.clear();
+		m_clipInsideDepth = CLIP_NOT_INSIDE;
+		m_countMaxDepth = 0;
+		m_countMaxHeight = 0;
+		m_countDeadEnds = 0;
+		if(first == last) {
+			return true;
+		}
+
+		TripletTriangle<I> m;
+		if(first == 0) {
+			enumerateCheck(m[0], m.path, "-P0", 0);
+			enumerateCheck(m[1], m.path, "-P1", 0);
+			enumerateCheck(m[2], m.path, "-P2", 0);
+		}
+
+		traverse(m, [&](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) -> const char * {
+			if(depth > splitDepth) {
+				return enumerateVisit(triangle, path, depth);
+			}
+
+			// the subtrees at the split under this node
+			unsigned long long index = 0;
+			path.rank(index);
+			unsigned long long count = TripletPath::rankCount(splitDepth - depth);
+			if(index * count + count <= first || index * count >= last) {
+				return nullptr;
+			}
+			return enumerateVisit(triangle, path, depth, index * count >= first);
+		});
+
+		m_visited.clear();
+		return true;
+	}
+
+	//
+	//	Parallel enumerate()
+	//	The tree is cut at a split depth into subtree tasks, which are dealt out to per-thread queues.
+	//	A thread that runs dry steals from the back of the other queues. Each task enumerates into
+	//	its own log, stopping at the result limit. As tasks finish, the walk above the split is
+	//	replayed here in serial pre-order, merging each task's log in its place, so the resulting set,
+	//	paths and counters are the same as enumerate()'s. A task whose log would reach the result limit
+	//	is walked again here instead, so the cut falls where enumerate()'s does, and tasks past it are
+	//	abandoned.
+	//
+	bool enumerateParallel(unsigned int numThreads = 0)
+	{
+		if(!numThreads) numThreads = (std::max)(1u, std::thread::hardware_concurrency());
+
+		assert(m_maxDepth < 1000);
+		assert(m_maxHeight > 1);
+		assert(m_clip.isTriangle());
+
+		cerr << "Enumerating depth: " << m_maxDepth << " max height: " << m_maxHeight
+			<< " max results: " << m_maxNumEnumerationResults << " threads: " << numThreads
+			<< "\nClip triangle:\n" << m_clip;
+
+		m_enumeration.clear();
+		m_visited.clear();
+		m_clipInsideDepth = CLIP_NOT_INSIDE;
+		m_depthCounts.clear();
+		m_countMaxDepth = 0;
+		m_countMaxHeight = 0;
+		m_countDeadEnds = 0;
+
+		// enough tasks per thread to even out irregular subtrees
+		unsigned int splitDepth = 0;
+		for(size_t n = 1; n < 16 * (size_t)numThreads && splitDepth < m_maxDepth; n *= 6) {
+			++splitDepth;
+		}
+
+		// the walk in serial order: a node above the split, or a task's subtree with what it found
+		struct EnumerationStep
+		{
+			TripletTriangle<I> root;
+			unsigned int depth = 0;
+			bool bTask = false;
+			bool bDone = false;
+			bool bTruncated = false;		// the task stopped at the result limit
+			vector<std::pair<Triplet<I>, string>> log;
+			int countMaxDepth = 0;
+			int countMaxHeight = 0;
+			int countDeadEnds = 0;
+			std::map<unsigned int, unsigned int> depthCounts;
+		};
+		std::deque<EnumerationStep> steps;
+
+		// walk the levels above the split, only to find the steps
+		TripletSearch top(*this);
+		top.m_bVerbose = false;
+
+		TripletTriangle<I> m;
+		top.traverse(m, [&](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) -> const char * {
+			steps.emplace_back();
+			steps.back().root = triangle;
+			steps.back().root.path = path;
+			steps.back().depth = depth;
+			if(depth < splitDepth) {
+				return top.enumerateVisit(triangle, path, depth);
+			}
+			steps.back().bTask = true;
+			return nullptr;
+		});
+
+		// applies the finished steps to this search, in order: a node above the split is visited again,
+		// a task's log is merged, or its subtree walked again if the log would reach the result limit
+		std::mutex mergeLock;
+		size_t next = 0;
+		std::atomic<size_t> end(steps.size());		// steps from here on aren't needed
+		auto advance = [&]() {
+			for(; next < end; ++next) {
+				EnumerationStep &step = steps[next];
+				if(!step.bTask) {
+					enumerateVisit(step.root, step.root.path, step.depth);
+				}
+				else if(!step.bDone) {
+					return;
+				}
+				else if(!step.bTruncated && enumerationCount() + countUnvisited(step.log) < m_maxNumEnumerationResults) {
+					for(auto &entry : step.log) {
+						if(m_visited.insert(entry.first)) m_enumeration.insert(std::move(entry));
+					}
+					m_countMaxDepth += step.countMaxDepth;
+					m_countMaxHeight += step.countMaxHeight;
+					m_countDeadEnds += step.countDeadEnds;
+					for(auto &count : step.depthCounts) {
+						m_depthCounts[count.first] += count.second;
+					}
+				}
+				else {
+					traverse(step.root, [this](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) {
+						return enumerateVisit(triangle, path, depth);
+					}, step.depth, &step.root.path);
+				}
+				vector<std::pair<Triplet<I>, string>>().swap(step.log);
+
+				if(enumerationCount() >= m_maxNumEnumerationResults) {
+					end = next + 1;
+				}
+			}
+		};
+
+		// the three basis points come first, as in enumerate()
+		enumerateCheck(m[0], m.path, "-P0", 0);
+		enumerateCheck(m[1], m.path, "-P1", 0);
+		enumerateCheck(m[2], m.path, "-P2", 0);
+		advance();
+
+		// deal contiguous runs of tasks, so neighbouring subtrees start on the same thread
+		vector<size_t> tasks;
+		for(size_t i = 0; i < steps.size(); ++i) {
+			if(steps[i].bTask) tasks.push_back(i);
+		}
+		struct WorkQueue
+		{
+			std::mutex lock;
+			std::deque<size_t> tasks;
+		};
+		vector<WorkQueue> queues(numThreads);
+		for(size_t i = 0; i < tasks.size(); ++i) {
+			queues[i * numThreads / tasks.size()].tasks.push_back(tasks[i]);
+		}
+
+		vector<TripletSearch> workers(numThreads, *this);
+		vector<std::thread> threads;
+		for(unsigned int t = 0; t < numThreads; ++t) {
+			threads.emplace_back([&, t]() {
+				TripletSearch &worker = workers[t];
+				worker.m_bVerbose = false;
+
+				for(;;) {
+					size_t task = SIZE_MAX;
+					{
+						std::lock_guard<std::mutex> guard(queues[t].lock);
+						if(!queues[t].tasks.empty()) {
+							task = queues[t].tasks.front();
+							queues[t].tasks.pop_front();
+						}
+					}
+					for(unsigned int k = 1; task == SIZE_MAX && k < numThreads; ++k) {
+						WorkQueue &victim = queues[(t + k) % numThreads];
+						std::lock_guard<std::mutex> guard(victim.lock);
+						if(!victim.tasks.empty()) {
+							task = victim.tasks.back();
+							victim.tasks.pop_back();
+						}
+					}
+					if(task == SIZE_MAX) break;
+
+					// results only need to be unique within a task; the merge dedups across tasks.
+					// a task past the result limit is dropped, even midway
+					EnumerationStep &step = steps[task];
+					if(task < end) {
+						worker.m_enumeration.clear();
+						worker.m_visited.clear();
+						worker.m_clipInsideDepth = CLIP_NOT_INSIDE;
+						worker.m_depthCounts.clear();
+						worker.m_countMaxDepth = 0;
+						worker.m_countMaxHeight = 0;
+						worker.m_countDeadEnds = 0;
+						worker.m_pEnumerationLog = &step.log;
+						worker.traverse(step.root, [&](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) -> const char * {
+							if(task >= end) return nullptr;
+							return worker.enumerateVisit(triangle, path, depth);
+						}, step.depth, &step.root.path);
+						worker.m_pEnumerationLog = nullptr;
+
+						step.bTruncated = worker.enumerationCount() >= m_maxNumEnumerationResults;
+						step.countMaxDepth = worker.m_countMaxDepth;
+						step.countMaxHeight = worker.m_countMaxHeight;
+						step.countDeadEnds = worker.m_countDeadEnds;
+						step.depthCounts.swap(worker.m_depthCounts);
+					}
+
+					std::lock_guard<std::mutex> guard(mergeLock);
+					step.bDone = true;
+					advance();
+				}
+				worker.m_enumeration.clear();
+				worker.m_visited.clear();
+			});
+		}
+		for(auto &thread : threads) {
+			thread.join();
+		}
+		advance();
+		assert(next >= end);
+
+		m_visited.clear();
+		return true;
+	}
+
+	//
+	//	Height-ordered enumeration
+	//	Streams triplets in Triplet::operator< priority order (increasing sum()) instead of tree order,
+	//	so stopping anywhere, or at m_maxNumEnumerationResults, leaves every triplet up to that height.
+	//	Everything found under a triangle is at least as high as its lowest edge midpoint, so the frontier
+	//	is a priority queue of triangles on that height, and a found triplet is held back until the frontier
+	//	has risen past it. Duplicates then come out adjacent and are dropped without a visited set,
+	//	so memory is bounded by the frontier rather than the output.
+	//	The same triplets as enumerate() are found; a triplet found more than once keeps its
+	//	shallowest path, rather than the first one in tree order.
+	//
+	bool enumerateByHeight(EnumerationCallback onTriplet) {
+		assert(m_maxDepth < 1000);
+		assert(m_maxHeight > 1);
+		assert(m_clip.isTriangle());
+
+		m_depthCounts.clear();
+		m_countMaxDepth = 0;
+		m_countMaxHeight = 0;
+		m_countDeadEnds = 0;
+
+		std::priority_queue<HeightFrontierNode> frontier;
+		std::priority_queue<HeightCandidate> candidates;
+
+		auto addCandidate = [&](const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth, bool bInside) {
+			if(magnitude(p.sum()) > (I)m_maxHeight || (!bInside && !m_clip.containsPoint(p))) return;
+			candidates.push({ p, path, suffix, depth });
+		};
+
+		TripletTriangle<I> node;
+		addCandidate(node[0], node.path, "-P0", 0, false);
+		addCandidate(node[1], node.path, "-P1", 0, false);
+		addCandidate(node[2], node.path, "-P2", 0, false);
+		frontier.push(HeightFrontierNode(node, TripletPath(), 0, false));
+
+		size_t count = 0;
+		Triplet<I> last(0, 0, 0);
+		for(;;) {
+			// nothing still to be found is lower than the frontier, so everything below it can go out
+			while(!candidates.empty() && (frontier.empty() || candidates.top().p.sum() < frontier.top().height)) {
+				HeightCandidate c = candidates.top();
+				candidates.pop();
+				if(c.p == last) continue;
+				if(count >= m_maxNumEnumerationResults) return true;
+
+				last = c.p;
+				onTriplet(c.p, c.path, c.suffix, c.depth);
+				++count;
+			}
+			if(frontier.empty()) break;
+
+			HeightFrontierNode f = frontier.top();
+			frontier.pop();
+
+			if(f.depth > m_maxDepth) {
+				++m_countMaxDepth;
+				continue;
+			}
+
+			// everything under this triangle is too high
+			if(f.height > (I)m_maxHeight) {
+				continue;
+			}
+
+			node.set(f.m[0], f.m[1], f.m[2]);
+			node.depth = f.triDepth;
+
+			// a triangle inside the clip passes that on to its whole subtree
+			bool bInside = f.bInside;
+			if(!bInside) {
+				ClipEnum clip = classifyClip(node);
+				if(clip == ClipEnum::OUTSIDE) {
+					continue;
+				}
+				bInside = (clip == ClipEnum::INSIDE);
+			}
+			++m_depthCounts[f.depth];
+
+			Triplet<I> ctr = node.centroid();
+			addCandidate(node[0] + node[1], f.path, "-p01", f.depth, bInside);
+			addCandidate(node[1] + node[2], f.path, "-p12", f.depth, bInside);
+			addCandidate(node[0] + node[2], f.path, "-p02", f.depth, bInside);
+			addCandidate(ctr, f.path, "-ctr", f.depth, bInside);
+
+			if(magnitude(ctr.sum()) > (I)m_maxHeight) {
+				++m_countMaxHeight;
+				continue;
+			}
+
+			for(const char *op = "xyzXYZ"; *op; ++op) {
+				TripletPath path(f.path);
+				if(!path.push_back(*op)) continue;
+				node.set(f.m[0], f.m[1], f.m[2]);
+				node.depth = f.triDepth;
+				node.apply(*op);
+				frontier.push(HeightFrontierNode(node, path, f.depth + 1, bInside));
+			}
+		}
+
+		return true;
+	}
+
+	// writes one enumeration CSV row: x,y,z,"path",depth
+	static void writeEnumerationRow(ostream &out, const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+		out << p.x << "," << p.y << "," << p.z << ",\"" << path << suffix << "\"," << depth;
+	}
+
+	// the suffixes enumerate() appends to paths, by their index in the binary formats
+	static const char *enumerationSuffix(int code) {
+		static const char *suffixes[] = { "-P0", "-P1", "-P2", "-p01", "-p12", "-p02", "-ctr" };
+		return (code >= 0 && code < 7) ? suffixes[code] : nullptr;
+	}
+
+	static int enumerationSuffixCode(const char *suffix) {
+		int code = (suffix[1] == 'P') ? suffix[2] - '0'
+			: (suffix[1] == 'c') ? 6
+			: (suffix[2] == '0') ? ((suffix[3] == '1') ? 3 : 5) : 4;
+		assert(!strcmp(enumerationSuffix(code), suffix));
+		return code;
+	}
+
+	// checkpointed enumerate(): the triplets found up to the last checkpoint saved or resumed from
+	unsigned long long checkpointedCount() const {
+		return m_checkpointedCount;
+	}
+
+	void dumpEnumerationResults() const {
+		for(auto i = m_enumeration.begin(); i != m_enumeration.end(); ++i) {
+			// key is the triplet, "[1,2,3]"
+			//cout << "\"" << i->first << "\",";
+			cout << i->second << endl;
+		}
+
+		cerr << "Enumerated " << m_enumeration.size() << " unique triplets.\n";
+		cerr << "Max depth: " << m_countMaxDepth << " Max height: " << m_countMaxHeight << endl;
+
+		for(auto i = m_depthCounts.begin(); i != m_depthCounts.end(); ++i) {
+			cerr << "Depth " << i->first << ": " << i->second << endl;
+		}
+	}
+
+private:
+
+	bool enumerateCheck(const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+		if(magnitude(p.sum()) > (I)m_maxHeight) {
+			return false;
+		}
+
+		if(enumerationCount() >= m_maxNumEnumerationResults) {
+			return false;
+		}
+
+		if(m_clipInsideDepth == CLIP_NOT_INSIDE && !m_clip.containsPoint(p)) {
+			return false;
+		}
+
+		if(!m_visited.insert(p)) {
+			return false;
+		}
+
+		enumerateEmit(p, path, suffix, depth);
+		if(m_bEnumerateImages) {
+			enumerateImages(p, path, suffix, depth);
+		}
+		return true;
+	}
+
+	void enumerateEmit(const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+		if(m_pCheckpoint) {
+			m_pCheckpoint->append(p, path, suffix, depth);
+		}
+
+		if(m_onTriplet) {
+			m_onTriplet(p, path, suffix, depth);
+		}
+		else {
+			// add CSV fields: x,y,z,path
+			stringstream str;
+			writeEnumerationRow(str, p, path, suffix, depth);
+			auto entry = m_enumeration.insert({ p, str.str() }).first;
+			if(m_pEnumerationLog) m_pEnumerationLog->push_back(*entry);
+		}
+	}
+
+	//
+	//	Symmetry-reduced enumerate()
+	//	The basis triangle is symmetric under the 6 permutations of (x, y, z). Permuting the
+	//	coordinates relabels each op's columns, so the subtree under each sextant op is an image of
+	//	the one under 'Z', the x <= y <= z sextant. Only the root and the 'Z' subtree are walked, and
+	//	each triplet found there is emitted along with its 5 images, with the ops in its path relabeled.
+	//	Images that coincide, for triplets on the medians x == y or y == z, are dropped by the visited
+	//	set like any other duplicate.
+	//
+	//	Depth and height limits are symmetric, so the triplets are the same as enumerate()'s, and so are
+	//	the counters, which are scaled by 6 below the root. A triplet found more than once may keep
+	//	a different one of its paths, and the result limit cuts the output at a different place.
+	//
+	bool m_bEnumerateImages = false;
+
+	bool isBasisClip() const {
+		return m_clip[0] == Triplet<I>(1, 0, 0) && m_clip[1] == Triplet<I>(0, 1, 0) && m_clip[2] == Triplet<I>(0, 0, 1);
+	}
+
+	void enumerateSymmetric(const TripletTriangle<I> &root) {
+		const char *ops = enumerateVisit(root, root.path, 0);
+		if(!ops || !*ops) {
+			return;
+		}
+
+		int countMaxDepth = m_countMaxDepth;
+		int countMaxHeight = m_countMaxHeight;
+		std::map<unsigned int, unsigned int> depthCounts;
+		depthCounts.swap(m_depthCounts);
+
+		TripletTriangle<I> sextant('Z', root);
+		initImageOps();
+		m_bEnumerateImages = true;
+		traverse(sextant, [this](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) {
+			return enumerateVisit(triangle, path, depth);
+		}, 1, &sextant.path);
+		m_bEnumerateImages = false;
+
+		// one subtree stands for 6
+		m_countMaxDepth = countMaxDepth + 6 * (m_countMaxDepth - countMaxDepth);
+		m_countMaxHeight = countMaxHeight + 6 * (m_countMaxHeight - countMaxHeight);
+		for(auto &count : m_depthCounts) {
+			depthCounts[count.first] += 6 * count.second;
+		}
+		depthCounts.swap(m_depthCounts);
+	}
+
+	// emits the other 5 permutations of a triplet found in the 'Z' sextant. The image has the
+	// triplet's height and the clip is the basis, so only the result limit and dedup apply
+	void enumerateImages(const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+		for(int i = 0; i < 5; ++i) {
+			const int *sigma = imagePermutations()[i];
+			if(enumerationCount() >= m_maxNumEnumerationResults) {
+				return;
+			}
+
+			Triplet<I> image;
+			const I *from = &p.x;
+			I *to = &image.x;
+			for(int j = 0; j < 3; ++j) to[sigma[j]] = from[j];
+			if(!m_visited.insert(image)) {
+				continue;
+			}
+
+			const char *ops = m_imageOps[i];
+			TripletPath imagePath;
+			path.forEach([&](char op) { imagePath.push_back(ops[op - 'X']); });
+			enumerateEmit(image, imagePath, permuteSuffix(suffix, sigma), depth);
+		}
+	}
+
+	// the permutations other than the identity; sigma[j] is where coordinate j goes
+	static const int (&imagePermutations())[5][3] {
+		static const int permutations[5][3] = { { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+		return permutations;
+	}
+
+	// per image, the cascade ops with their columns relabeled, merge3(p, s) -> merge3(sigma[p], sigma[s]),
+	// indexed by op - 'X'
+	char m_imageOps[5]['z' - 'X' + 1];
+
+	void initImageOps() {
+		static const char merge3ops[3][3] = {
+			{ 0, 'x', 'X' },
+			{ 'Y', 0, 'y' },
+			{ 'z', 'Z', 0 } };
+		for(int i = 0; i < 5; ++i) {
+			const int *sigma = imagePermutations()[i];
+			for(int p = 0; p < 3; ++p) {
+				for(int s = 0; s < 3; ++s) {
+					if(p != s) m_imageOps[i][merge3ops[p][s] - 'X'] = merge3ops[sigma[p]][sigma[s]];
+				}
+			}
+		}
+	}
+
+	// "-p01" names the midpoint of columns 0 and 1, which become columns sigma[0] and sigma[1]
+	static const char *permuteSuffix(const char *suffix, const int sigma[3]) {
+		if(suffix[0] != '-' || suffix[1] != 'p') {
+			return suffix;
+		}
+		static const char *midpoints[3] = { "-p12", "-p02", "-p01" };		// by the column left out
+		return midpoints[3 - sigma[suffix[2] - '0'] - sigma[suffix[3] - '0']];
+	}
+
+	//
+	//	Checkpointed enumerate()
+	//	Each new triplet is appended to <m_checkpointFile>.log as a binary record. Every m_checkpointSeconds
+	//	the log is flushed, and the checkpoint file rewritten with the limits, the counters, the log's length
+	//	so far, its watermark, and the path of the next node to visit. The walk is in pre-order, so that path
+	//	stands for the whole traversal stack. The checkpoint is small and the log is only appended to, so
+	//	a checkpoint costs the same however far the enumeration has got. It is written under a temporary
+	//	name and renamed, so a crash leaves the previous one.
+	//
+	//	Resuming reloads the log up to the watermark, ignoring anything written after it, into the dedup set
+	//	and m_enumeration, and restores the counters. It then walks through the next node's ancestors, as
+	//	the sharded enumerate() walks through another shard's, skipping the subtrees finished before it,
+	//	and carries on as if never stopped. A streaming consumer has already been sent the rows past
+	//	the watermark; checkpointedCount() is how many rows to keep.
+	//
+	struct EnumerationCheckpoint
+	{
+		TripletSearch *search;
+		std::fstream log;
+		string pending;						// records not yet written to the log
+		vector<unsigned char> packed;
+		unsigned long long numPending = 0;		// records since the last checkpoint
+		unsigned long long pendingBytes = 0;	// their bytes already written to the log
+		unsigned long long numRecords = 0;	// up to the last checkpoint
+		unsigned long long logBytes = 0;
+		std::chrono::steady_clock::time_point saved = std::chrono::steady_clock::now();
+
+		explicit EnumerationCheckpoint(TripletSearch *owner) : search(owner) { search->m_pCheckpoint = this; }
+		~EnumerationCheckpoint() { search->m_pCheckpoint = nullptr; }
+
+		// record: x, y, z, depth (32 bits), suffix index (8 bits), path nibbles (32 bits), packed path.
+		// records are written out in 1 MB runs, so memory stays bounded between checkpoints
+		void append(const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+			unsigned char code = (unsigned char)enumerationSuffixCode(suffix);
+			unsigned int nibbles = (unsigned int)path.nibbles();
+
+			char record[3 * sizeof(I) + 9];
+			memcpy(record, &p.x, sizeof(I));
+			memcpy(record + sizeof(I), &p.y, sizeof(I));
+			memcpy(record + 2 * sizeof(I), &p.z, sizeof(I));
+			memcpy(record + 3 * sizeof(I), &depth, 4);
+			record[3 * sizeof(I) + 4] = (char)code;
+			memcpy(record + 3 * sizeof(I) + 5, &nibbles, 4);
+			pending.append(record, sizeof(record));
+			pending.append((const char *)path.data(), path.bytes());
+			++numPending;
+
+			if(pending.size() >= (1 << 20)) {
+				log.write(pending.data(), pending.size());
+				pendingBytes += pending.size();
+				pending.clear();
+			}
+		}
+
+		bool read(Triplet<I> &p, TripletPath &path, const char *&suffix, unsigned int &depth) {
+			unsigned int nibbles = 0;
+			unsigned char code = 0;
+			log.read((char *)&p.x, sizeof(I));
+			log.read((char *)&p.y, sizeof(I));
+			log.read((char *)&p.z, sizeof(I));
+			log.read((char *)&depth, sizeof(depth));
+			log.read((char *)&code, sizeof(code));
+			log.read((char *)&nibbles, sizeof(nibbles));
+			packed.resize((nibbles + 1) / 2 + 1);
+			log.read((char *)packed.data(), (nibbles + 1) / 2);
+			path.assign(packed.data(), nibbles);
+			suffix = enumerationSuffix(code);
+			return log && suffix;
+		}
+	};
+
+	EnumerationCheckpoint *m_pCheckpoint = nullptr;
+	unsigned long long m_checkpointedCount = 0;
+
+	static const unsigned int CHECKPOINT_MAGIC = 0x4b434545;		// "EECK"
+
+	template<class T>
+	static void writeRaw(ostream &out, const T &value) {
+		out.write((const char *)&value, sizeof(T));
+	}
+
+	template<class T>
+	static bool readRaw(istream &in, T &value) {
+		return !!in.read((char *)&value, sizeof(T));
+	}
+
+	bool enumerateCheckpointed() {
+		EnumerationCheckpoint checkpoint(this);
+		m_depthCounts.clear();
+		TripletTriangle<I> m;
+		TripletPath next;
+		bool bDone = false;
+
+		if(m_bResume && std::ifstream(m_checkpointFile).good()) {
+			if(!loadCheckpoint(next, bDone)) {
+				return false;
+			}
+			if(bDone) {
+				return true;
+			}
+		}
+		else {
+			checkpoint.log.open(m_checkpointFile + ".log", std::ios::out | std::ios::binary | std::ios::trunc);
+			m_checkpointedCount = 0;
+			enumerateCheck(m[0], m.path, "-P0", 0);
+			enumerateCheck(m[1], m.path, "-P1", 0);
+			enumerateCheck(m[2], m.path, "-P2", 0);
+			if(!saveCheckpoint(next, false)) {
+				return false;
+			}
+		}
+
+		bool bResuming = !next.empty();
+		unsigned int numNodes = 0;
+		traverse(m, [&](const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth) -> const char * {
+			if(bResuming) {
+				if(path < next) {
+					// finished before the checkpoint, but for the walk down to it
+					return path.isPrefixOf(next) ? enumerateVisit(triangle, path, depth, false) : nullptr;
+				}
+				bResuming = false;
+			}
+
+			if(!(++numNodes & 1023)) {
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - checkpoint.saved;
+				if(elapsed.count() >= m_checkpointSeconds) {
+					saveCheckpoint(path, false);
+				}
+			}
+			return enumerateVisit(triangle, path, depth);
+		});
+
+		return saveCheckpoint(TripletPath(), true);
+	}
+
+	// flushes the log and records next, the node to resume at
+	bool saveCheckpoint(const TripletPath &next, bool bDone) {
+		EnumerationCheckpoint &checkpoint = *m_pCheckpoint;
+		checkpoint.log.write(checkpoint.pending.data(), checkpoint.pending.size());
+		checkpoint.log.flush();
+		if(!checkpoint.log) {
+			cerr << "Can't write " << m_checkpointFile << ".log\n";
+			return false;
+		}
+		checkpoint.logBytes += checkpoint.pendingBytes + checkpoint.pending.size();
+		checkpoint.numRecords += checkpoint.numPending;
+		checkpoint.pending.clear();
+		checkpoint.numPending = 0;
+		checkpoint.pendingBytes = 0;
+		checkpoint.saved = std::chrono::steady_clock::now();
+		m_checkpointedCount = checkpoint.numRecords;
+
+		string temp = m_checkpointFile + ".tmp";
+		{
+			std::ofstream out(temp, std::ios::binary);
+			writeRaw(out, (unsigned int)CHECKPOINT_MAGIC);
+			writeRaw(out, (unsigned int)sizeof(I));
+			writeRaw(out, m_maxDepth);
+			writeRaw(out, m_maxHeight);
+			for(int i = 0; i < 3; ++i) writeRaw(out, m_clip[i]);
+			writeRaw(out, (unsigned char)bDone);
+			writeRaw(out, checkpoint.numRecords);
+			writeRaw(out, checkpoint.logBytes);
+			writeRaw(out, m_countMaxDepth);
+			writeRaw(out, m_countMaxHeight);
+			writeRaw(out, m_countDeadEnds);
+			writeRaw(out, (unsigned int)m_depthCounts.size());
+			for(auto &count : m_depthCounts) {
+				writeRaw(out, count.first);
+				writeRaw(out, count.second);
+			}
+			writeRaw(out, next.nibbles());
+			out.write((const char *)next.data(), next.bytes());
+			if(!out.flush()) {
+				cerr << "Can't write " << temp << endl;
+				return false;
+			}
+		}
+		::remove(m_checkpointFile.c_str());
+		return !::rename(temp.c_str(), m_checkpointFile.c_str());
+	}
+
+	// restores the counters and the results up to the watermark, and the node to resume at
+	bool loadCheckpoint(TripletPath &next, bool &bDone) {
+		EnumerationCheckpoint &checkpoint = *m_pCheckpoint;
+		std::ifstream in(m_checkpointFile, std::ios::binary);
+		unsigned int magic = 0, size = 0, maxDepth = 0, maxHeight = 0, numDepths = 0, nibbles = 0;
+		Triplet<I> clip[3];
+		unsigned char done = 0;
+		bool bRead = readRaw(in, magic) && readRaw(in, size) && readRaw(in, maxDepth) && readRaw(in, maxHeight)
+			&& readRaw(in, clip[0]) && readRaw(in, clip[1]) && readRaw(in, clip[2]) && readRaw(in, done)
+			&& readRaw(in, checkpoint.numRecords) && readRaw(in, checkpoint.logBytes)
+			&& readRaw(in, m_countMaxDepth) && readRaw(in, m_countMaxHeight) && readRaw(in, m_countDeadEnds)
+			&& readRaw(in, numDepths);
+		if(!bRead || magic != CHECKPOINT_MAGIC || size != sizeof(I)) {
+			cerr << "Not a checkpoint: " << m_checkpointFile << endl;
+			return false;
+		}
+		if(maxDepth != m_maxDepth || maxHeight != m_maxHeight || !(clip[0] == m_clip[0] && clip[1] == m_clip[1] && clip[2] == m_clip[2])) {
+			cerr << "Checkpoint " << m_checkpointFile << " is for a different enumeration\n";
+			return false;
+		}
+		for(unsigned int i = 0; bRead && i < numDepths; ++i) {
+			unsigned int depth = 0, count = 0;
+			bRead = readRaw(in, depth) && readRaw(in, count);
+			m_depthCounts[depth] = count;
+		}
+		vector<unsigned char> packed;
+		bRead = bRead && readRaw(in, nibbles);
+		packed.resize((nibbles + 1) / 2);
+		bRead = bRead && (packed.empty() || in.read((char *)packed.data(), packed.size()));
+		if(!bRead) {
+			cerr << "Truncated checkpoint: " << m_checkpointFile << endl;
+			return false;
+		}
+		next.assign(packed.data(), nibbles);
+		bDone = !!done;
+
+		// the log past the watermark is overwritten from here on
+		checkpoint.log.open(m_checkpointFile + ".log", std::ios::in | std::ios::out | std::ios::binary);
+		for(unsigned long long i = 0; i < checkpoint.numRecords; ++i) {
+			Triplet<I> p;
+			TripletPath path;
+			const char *suffix = nullptr;
+			unsigned int depth = 0;
+			if(!checkpoint.read(p, path, suffix, depth)) {
+				cerr << "Truncated log: " << m_checkpointFile << ".log\n";
+				return false;
+			}
+			m_visited.insert(p);
+			if(!m_onTriplet) {
+				stringstream str;
+				writeEnumerationRow(str, p, path, suffix, depth);
+				m_enumeration.insert({ p, str.str() });
+			}
+		}
+		checkpoint.log.clear();
+		checkpoint.log.seekp(checkpoint.logBytes);
+		m_checkpointedCount = checkpoint.numRecords;
+		return !!checkpoint.log;
+	}
+
+	std::map<unsigned int, unsigned int> m_depthCounts;
+
+	// streaming enumeration callback
+	EnumerationCallback m_onTriplet;
+
+	// enumeration dedup: every triplet accepted so far, in both the collecting and streaming modes
+	TripletHashSet<I> m_visited;
+
+	size_t enumerationCount() const {
+		return m_visited.size();
+	}
+
+	//
+	//	Clip fast path
+	//	Every descendant of a triangle lies inside it, so once a triangle is inside the clip, its
+	//	whole subtree is, and no clip test is needed until the walk leaves it. The walk is depth-first,
+	//	so it is enough to remember the depth of that subtree's root: the walk has left the subtree
+	//	as soon as it visits a node at that depth or above.
+	//
+	enum class ClipEnum { OUTSIDE, BOUNDARY, INSIDE };
+	static const unsigned int CLIP_NOT_INSIDE = ~0u;
+	unsigned int m_clipInsideDepth = CLIP_NOT_INSIDE;
+
+	ClipEnum classifyClip(const TripletTriangle<I> &triangle) const {
+		int contained = (int)m_clip.containsPoint(triangle[0])
+			+ (int)m_clip.containsPoint(triangle[1])
+			+ (int)m_clip.containsPoint(triangle[2]);
+		if(contained == 3) return ClipEnum::INSIDE;
+		if(contained || trianglesIntersect(triangle, m_clip)) return ClipEnum::BOUNDARY;
+		return ClipEnum::OUTSIDE;
+	}
+
+	// enumerateByHeight() frontier triangle, keyed on the height of its lowest edge midpoint.
+	// operator < follows Triplet's: lower priority means higher
+	struct HeightFrontierNode
+	{
+		Triplet<I> m[3];
+		unsigned int triDepth;
+		unsigned int depth;
+		TripletPath path;
+		I height;
+		bool bInside;		// inside the clip; no further clip tests
+
+		HeightFrontierNode(const TripletTriangle<I> &triangle, const TripletPath &nodePath, unsigned int nodeDepth, bool bInsideClip)
+			: triDepth(triangle.depth), depth(nodeDepth), path(nodePath), bInside(bInsideClip)
+		{
+			I highest = 0;
+			height = 0;
+			for(int i = 0; i < 3; ++i) {
+				m[i] = triangle[i];
+				I h = m[i].sum();
+				height += h;
+				highest = (std::max)(highest, h);
+			}
+			height -= highest;
+		}
+
+		bool operator < (const HeightFrontierNode &rhs) const { return height > rhs.height; }
+	};
+
+	// enumerateByHeight() found triplet, waiting for the frontier to pass it.
+	// ties between copies of the same triplet go to the shallowest, then the smallest, path
+	struct HeightCandidate
+	{
+		Triplet<I> p;
+		TripletPath path;
+		const char *suffix;
+		unsigned int depth;
+
+		bool operator < (const HeightCandidate &rhs) const {
+			if(p < rhs.p) return true;
+			if(rhs.p < p) return false;
+			if(depth != rhs.depth) return depth > rhs.depth;
+			return rhs.path < path;
+		}
+	};
+
+	// entries of a task's log that haven't been enumerated yet
+	size_t countUnvisited(const vector<std::pair<Triplet<I>, string>> &log) const {
+		size_t count = 0;
+		for(auto &entry : log) {
+			if(!m_visited.contains(entry.first)) ++count;
+		}
+		return count;
+	}
+
+	void enumerateR(const TripletTriangle<I> &triangle, unsigned int depth) {
+		const char *ops = enumerateVisit(triangle, triangle.path, depth);
+		for(; ops && *ops; ++ops) {
+			enumerateR(TripletTriangle<I>(*ops, triangle), depth + 1);
+		}
+	}
+
+	// enumerate() step: records the triangle's midpoints and centroid, and returns the ops to expand
+	// a node that isn't bOwned is only walked through, to reach a shard's subtrees: it is pruned
+	// as usual, but neither counted nor enumerated
+	const char *enumerateVisit(const TripletTriangle<I> &triangle, const TripletPath &path, unsigned int depth, bool bOwned = true) {
+
+		if(depth > m_maxDepth) {
+			if(bOwned) ++m_countMaxDepth;
+			return nullptr;
+		}
+
+		if(enumerationCount() >= m_maxNumEnumerationResults) {
+			//cerr << ".. max results reached: " << m_enumeration.size() << " ..";
+			return nullptr;
+		}
+
+		// inside a subtree whose root is inside the clip? otherwise that subtree has been left
+		if(depth <= m_clipInsideDepth) {
+			m_clipInsideDepth = CLIP_NOT_INSIDE;
+
+			ClipEnum clip = classifyClip(triangle);
+			if(clip == ClipEnum::OUTSIDE) {
+				return nullptr;
+			}
+			if(clip == ClipEnum::INSIDE) {
+				m_clipInsideDepth = depth;
+			}
+		}
+
+		Triplet<I> ctr = triangle.centroid();
+		assert(ctr.isCoprime());
+		if(bOwned) {
+			if(m_bVerbose)
+				cerr << "Intersection: depth=" << depth << endl << triangle;
+			++m_depthCounts[depth];
+
+			// the triangle edge midpoints and centroid
+			enumerateCheck(triangle[0] + triangle[1], path, "-p01", depth);
+			enumerateCheck(triangle[1] + triangle[2], path, "-p12", depth);
+			enumerateCheck(triangle[0] + triangle[2], path, "-p02", depth);
+			enumerateCheck(ctr, path, "-ctr", depth);
+		}
+
+		if(magnitude(ctr.sum()) > (I)m_maxHeight) {
+			if(bOwned) ++m_countMaxHeight;
+			return nullptr;
+		}
+
+		return "xyzXYZ";
+	}
+
+	//
+	//	Traversal engine
+	//	Depth-first, pre-order walk shared by search(), findAll() and enumerate().
+	//	Replaces recursion with an explicit stack of frames that is reused between calls,
+	//	and a single path that is pushed and popped in step, so no frame carries its own path.
+	//
+	//	visit(triangle, path, depth) is called once per node and returns the ops to expand
+	//	in order, or null for a leaf. The returned string must outlive the node's subtree.
+	//	A subtree can be walked on its own by passing its root's depth and path.
+	//
+	struct TraversalFrame
+	{
+		Triplet<I> m[3];
+		unsigned int triDepth;
+		const char *ops;
+	};
+
+	vector<TraversalFrame> m_stack;
+	TripletPath m_stackPath;
+
+	template<class Visit>
+	void traverse(const TripletTriangle<I> &root, Visit visit, unsigned int rootDepth = 0, const TripletPath *rootPath = nullptr)
+	{
+		m_stack.clear();
+		m_stack.reserve((std::min)(m_maxDepth + 2, 4096u));
+		m_stackPath.clear();
+		if(rootPath) m_stackPath = *rootPath;
+
+		// frames hold only the matrix; each node is rebuilt in this scratch triangle
+		TripletTriangle<I> node;
+		node.set(root[0], root[1], root[2]);
+		node.depth = root.depth;
+
+		const char *ops = visit(node, m_stackPath, rootDepth);
+		if(!ops || !*ops) return;
+		m_stack.push_back({ { node[0], node[1], node[2] }, node.depth, ops });
+
+		while(!m_stack.empty())
+		{
+			TraversalFrame &frame = m_stack.back();
+			if(!*frame.ops)
+			{
+				m_stack.pop_back();
+				if(!m_stack.empty()) m_stackPath.pop_back();
+				continue;
+			}
+
+			char op = *frame.ops++;
+			if(!m_stackPath.push_back(op)) continue;
+
+			node.set(frame.m[0], frame.m[1], frame.m[2]);
+			node.depth = frame.triDepth;
+			node.apply(op);
+
+			ops = visit(node, m_stackPath, rootDepth + (unsigned int)m_stack.size());
+			if(ops && *ops)
+			{
+				m_stack.push_back({ { node[0], node[1], node[2] }, node.depth, ops });
+			}
+			else
+			{
+				m_stackPath.pop_back();
+			}
+		}
+	}
+
+	public:
+
+	static int runTests() 
+	{
+		// GCD algs
+		{
+			int nn[12] = { 16, 16, 16, 27, 27, 9, 0, 0, 0, 8, 8, 8 };
+			assert(::gcd(nn, 12) == 1);
+			int mm[12] = { 48, 15, 12, 27, 27, 9, 0, 0, 0, 90, 24, 21 };
+			assert(::gcd(mm, 12) == 3);
+
+			assert(::gcd(8, 1) == 1);
+			assert(::gcd(0, 1) == 1);
+			assert(::gcd(0, 8) == 8);
+			assert(::gcd(40, 32) == 8);
+			assert(::gcd(0, 0) == 0);
+
+			int n[3] = { 8, 8, 8 };
+			assert(::gcd(n, 3) == 8);
+			n[2] = 5;
+			assert(::gcd(n, 3) == 1);
+			n[2] = 0;
+			assert(::gcd(n, 3) == 8);
+			n[1] = 0;
+			assert(::gcd(n, 3) == 8);
+			n[0] = 0;
+			assert(::gcd(n, 3) == 0);
+
+			// binary gcd against Euclid's, including zeros and negatives
+			static_assert(gcdBinary(40, 32) == 8 && gcdBinary(0, 0) == 0 && gcdBinary(-12, 18, 27) == 3, "constexpr gcd");
+			assert(gcdBinary(nn, 12) == 1 && gcdBinary(mm, 12) == 3 && gcd2(mm, 12) == 3);
+			for(int a = -40; a <= 40; ++a) {
+				for(int b = -40; b <= 40; ++b) {
+					assert(gcdBinary(a, b) == ::gcd(magnitude(a), magnitude(b)));
+				}
+			}
+			assert(gcdBinary(1LL << 62, 3LL << 40) == 1LL << 40);
+
+			// batched form, across the 8-lane blocks and the tail
+			TripletBlock<int> block;
+			srand(3);
+			for(int i = 0; i < 1003; ++i) {
+				int scale = (i % 5) + 1;
+				block.push_back(vec3(scale * (rand() % 1000 - 100), scale * (rand() % 1000), scale * (rand() % 1000 + 1)));
+			}
+			block.push_back(vec3(0, 0, 0));
+			block.push_back(vec3(0, 0, 7));
+			block.push_back(vec3(-(1 << 30), 1 << 29, 0));
+			vector<int> g(block.size());
+			block.gcds(g.data());
+			for(size_t i = 0; i < block.size(); ++i) {
+				assert(g[i] == gcdBinary(block[i].x, block[i].y, block[i].z));
+				assert(g[i] == ::gcd(magnitude(block[i].x), ::gcd(magnitude(block[i].y), magnitude(block[i].z))));
+			}
+		}
+
+		// packed paths
+		{
+			TripletPath path("xyZ{YZ}rlJO{XY}bBcC");
+			assert(path.size() == 13);
+			assert(path.nibbles() == 15);
+			assert(path.ops() == "xyZ2rlJO1bBcC");
+			assert(path.str() == "xyZ{YZ}rlJO{XY}bBcC");
+			assert(TripletPath(path.ops()) == path);
+
+			TripletPath prefix;
+			assert(!prefix.assign("xyZ{YZ}rl!"));
+			assert(prefix.str() == "xyZ{YZ}rl");
+			assert(prefix < path && !(path < prefix));
+
+			// spill to heap and back
+			TripletPath deep(path);
+			for(int i = 0; i < 200; ++i)
+				deep.push_back("xyzXYZ"[i % 6]);
+			assert(deep.size() == 213);
+			TripletPath copy(deep);
+			assert(copy == deep && copy.hash() == deep.hash());
+			for(int i = 0; i < 200; ++i)
+				deep.pop_back();
+			assert(deep == path && deep.hash() == path.hash());
+			deep.pop_back();
+			deep.pop_back();
+			deep.pop_back();
+			deep.pop_back();
+			deep.pop_back();
+			deep.pop_back();
+			assert(deep.str() == "xyZ{YZ}rlJ");
+		}
+
+		// compile-time ops and the dispatch table agree with operate()
+		{
+			TripletTriangle<int> tri;
+			assert(tri.operate<Op::x>() && tri.path.str() == "x");
+			assert(tri[0] == vec3(1, 0, 0) && tri[1] == vec3(1, 1, 0) && tri[2] == vec3(1, 1, 1));
+
+			const string ops = "xyzXYZlrbBcCJKLMNO123";
+			auto compiled = TripletOpTable<int>::compile(ops + "!?");
+			assert(compiled.size() == ops.size());
+			assert(!TripletOpTable<int>::lookup('!') && !TripletOpTable<int>::lookup((char)0xC8));
+			srand(5);
+			for(int i = 0; i < 200; ++i) {
+				TripletTriangle<int> a, b;
+				for(int j = 0; j < 12; ++j) {
+					int k = rand() % (int)ops.size();
+					bool ok = a.operate(ops[k]);
+					assert(compiled[k].op == ops[k]);
+					assert(compiled[k].apply(b) == ok);
+					assert(a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a.depth == b.depth);
+				}
+			}
+
+			// the sextant alphabet visits the same tree as the op string
+			assert(string(SextantOps::str()) == "xyzXYZ" && SextantOps::SIZE == 6);
+			vector<Triplet<int>> expanded, stepped;
+			SextantOps::traverse(TripletTriangle<int>(), 3, [&](const TripletTriangle<int> &t, unsigned int) {
+				expanded.push_back(t.centroid());
+				return true;
+			});
+			std::function<void(const TripletTriangle<int> &, int)> step = [&](const TripletTriangle<int> &t, int depth) {
+				stepped.push_back(t.centroid());
+				if(depth == 3) return;
+				for(char op : string("xyzXYZ")) step(t + op, depth + 1);
+			};
+			step(TripletTriangle<int>(), 0);
+			assert(expanded.size() == 1 + 6 + 36 + 216 && expanded == stepped);
+		}
+
+		// block-composed path evaluation matches operate(), including ops outside the blocks and collapses
+		{
+			const string ops = "xyzXYZxyzXYZxyzXYZlrbBcCJKLMNO123";
+			vector<TripletPath> paths;
+			srand(9);
+			for(int i = 0; i < 300; ++i) {
+				string str;
+				int length = rand() % 40;
+				for(int j = 0; j < length; ++j) {
+					// mostly sextant ops, so that whole blocks occur
+					str += (rand() % 4) ? "xyzXYZ"[rand() % 6] : ops[rand() % ops.size()];
+				}
+				paths.push_back(TripletPath(str));
+			}
+			std::sort(paths.begin(), paths.end());
+
+			TripletTriangle<int> root('y', TripletTriangle<int>());
+			for(int k = 1; k <= 5; ++k) {
+				TripletPathEvaluator<int> evaluator(k);
+				vector<TripletTriangle<int>> batch;
+				evaluator.evaluate(paths, batch, root);
+				for(size_t i = 0; i < paths.size(); ++i) {
+					TripletTriangle<int> expected(root);
+					paths[i].forEach([&](char op) { expected.operate(op); });
+					TripletTriangle<int> single = evaluator.evaluate(paths[i], root);
+					for(const TripletTriangle<int> *t : { &single, &batch[i] }) {
+						assert(t->m[0] == expected[0] && t->m[1] == expected[1] && t->m[2] == expected[2]);
+						assert(t->depth == expected.depth && t->path == expected.path);
+					}
+				}
+			}
+		}
+
+		// hash set
+		{
+			TripletHashSet<int> set;
+			assert(set.insert(vec3(1, 2, 3)));
+			assert(!set.insert(vec3(1, 2, 3)));
+			assert(set.insert(vec3(3, 2, 1)));
+			assert(set.insert(vec3(0, 0, 0)));
+			assert(!set.insert(vec3(0, 0, 0)));
+			assert(set.size() == 3);
+			assert(set.contains(vec3(0, 0, 0)) && !set.contains(vec3(2, 2, 2)));
+
+			// grows through several rehashes without losing entries
+			for(int i = -200; i < 200; ++i) {
+				set.insert(vec3(i, i * i, -i));
+			}
+			assert(set.size() == 402);
+			for(int i = -200; i < 200; ++i) {
+				assert(set.contains(vec3(i, i * i, -i)));
+			}
+			set.clear();
+			assert(set.empty() && !set.contains(vec3(1, 2, 3)));
+		}
+
+		// triangle algs
+
+		TripletTriangle<int> tri;
+
+		for(int i = 0; i < 1000; ++i) {
+			tri = TripletTriangle<int>();
+			for(int j = 0; j < 20; ++j) {
+				int c = rand() % 3;
+				int d = (c + 1 + rand() % 2) % 3;
+				tri.merge(c, d);
+				assert(tri.isCoprime());
+				tri = tri.transpose();
+				c = rand() % 3;
+				d = (c + 1 + rand() % 2) % 3;
+				tri.merge(c, d);
+				assert(tri.isCoprime());
+			}
+		}
+
+		// math: any matrix with det == 1 is coprime? (yes--all rows and columns)
+		// however the converse is not true
+		for(int count = 0; count < 100; ) {
+			for(int i = 0; i < 3; ++i) {
+				tri[i].x = rand() % 17;
+				tri[i].y = rand() % 16;
+				tri[i].z = rand() % 20;
+				if(tri.determinant() == 1) {
+					stringstream str;
+					str << tri << " iscoprime: " << tri.isCoprime() << endl;
+					TRACE(str.str().c_str());
+					assert(tri.isCoprime());
+					assert(tri.transpose().isCoprime());
+					++count;
+				}
+			}
+		}
+
+		TripletTriangle<I> mBase;
+		assert(mBase.isCoprime());
+		assert(mBase.isTriangle());
+		assert(leftOf(mBase[0], mBase[1], mBase[2]));
+
+		TripletTriangle<I> mTest1(vec3(15, 10, 8), vec3(6, 4, 3), vec3(25, 17, 14));
+		TripletTriangle<I> mTest2(vec3(15, 10, 8), vec3(21, 14, 11), vec3(46, 31, 25));
+		bool bb;
+
+		cout << "Test 1\n" << mTest1;
+		assert(mTest1.isCoprime());
+		assert(mTest1.isTriangle());
+		bb = mTest1.containsPoint(vec3(36, 24, 19));
+		assert(bb);
+
+		cout << "Test 2\n" << mTest2;
+		assert(mTest2.isCoprime());
+		assert(mTest2.isTriangle());
+		bb = mTest2.containsPoint(vec3(36, 24, 19));
+		assert(bb);
+
+		int signabc;
+		vec3 a(1, 1, 1), b(3, 1, 2), c(3, 2, 1), temp;
+		signabc = leftOf(a, b, c);
+		assert(signabc == 1);
+		cout << "leftof(" << a << " , " << b << " , " << c << " ): " << signabc << endl;
+		temp = a; a = b; b = temp;
+		signabc = leftOf(a, b, c);
+		assert(signabc == -1);
+		cout << "leftof(" << a << " , " << b << " , " << c << " ): " << signabc << endl;
+		a.set(1, 0, 0); b.set(0, 1, 0); c.set(0, 0, 1);
+		signabc = leftOf(a, b, c);
+		assert(signabc == 1);
+		cout << "leftof(" << a << " , " << b << " , " << c << " ): " << signabc << endl;
+		// collinear test
+		a.set(3, 3, 4); b.set(3, 4, 6); c.set(3, 5, 8);
+		signabc = leftOf(a, b, c);
+		assert(signabc == 0);
+		cout << "leftof(" << a << " , " << b << " , " << c << " ): " << signabc << endl;
+
+		TripletSearch<int> s;
+		s.m_growth = GrowthEnum::POINT_SEARCH;
+		s.m_bVerbose = false;
+        s.m_maxDepth = 5;
+		TripletTriangle<I> t;
+		for(int i = 1; i <= 5; ++i) 
+		{
+			for(int j = 1; j <= i; ++j) 
+			{
+				for(int k = 1; k <= j; ++k) 
+				{
+					vec3 pt(i, j, k);
+					if(pt.isCoprime()) 
+					{
+						SexClass sex = t.getSextant(pt);
+						cout << pt << " Sex: " << sex.asChar;
+
+						s.search(pt);
+						cout << " search: " << s.m_paths.size() << " paths";
+
+						assert(s.m_paths.size() == 1);
+                        cout << " " << s.m_paths[0] << endl;
+
+						s.findAll(pt);
+						cout << " findAll: " << s.m_paths.size() << " paths found.\n";
+					}
+				}
+			}
+		}
+		assert(t.getSextant(vec3(1, 1, 1)).asInt == *((int*)("000")));
+		assert(t.getSextant(vec3(1, 1, 2)).asInt == *((int*)("-+0")));
+		assert(t.getSextant(vec3(1, 1, 3)).asInt == *((int*)("-+0")));
+		assert(t.getSextant(vec3(1, 2, 1)).asInt == *((int*)("+0-")));
+		assert(t.getSextant(vec3(1, 2, 2)).asInt == *((int*)("0+-")));
+		assert(t.getSextant(vec3(1, 2, 3)).asInt == *((int*)("-+-")));
+		assert(t.getSextant(vec3(1, 3, 1)).asInt == *((int*)("+0-")));
+		assert(t.getSextant(vec3(1, 3, 2)).asInt == *((int*)("++-")));
+		assert(t.getSextant(vec3(1, 3, 3)).asInt == *((int*)("0+-")));
+		assert(t.getSextant(vec3(2, 1, 1)).asInt == *((int*)("0-+")));
+		assert(t.getSextant(vec3(2, 1, 2)).asInt == *((int*)("-0+")));
+		assert(t.getSextant(vec3(2, 1, 3)).asInt == *((int*)("-++")));
+		assert(t.getSextant(vec3(2, 2, 1)).asInt == *((int*)("+-0")));
+		assert(t.getSextant(vec3(2, 2, 3)).asInt == *((int*)("-+0")));
+		assert(t.getSextant(vec3(2, 3, 1)).asInt == *((int*)("+--")));
+		assert(t.getSextant(vec3(2, 3, 2)).asInt == *((int*)("+0-")));
+		assert(t.getSextant(vec3(2, 3, 3)).asInt == *((int*)("0+-")));
+		assert(t.getSextant(vec3(3, 1, 1)).asInt == *((int*)("0-+")));
+		assert(t.getSextant(vec3(3, 1, 2)).asInt == *((int*)("--+")));
+		assert(t.getSextant(vec3(3, 1, 3)).asInt == *((int*)("-0+")));
+		assert(t.getSextant(vec3(3, 2, 1)).asInt == *((int*)("+-+")));
+		assert(t.getSextant(vec3(3, 2, 2)).asInt == *((int*)("0-+")));
+		assert(t.getSextant(vec3(3, 2, 3)).asInt == *((int*)("-0+")));
+		assert(t.getSextant(vec3(3, 3, 1)).asInt == *((int*)("+-0")));
+		assert(t.getSextant(vec3(3, 3, 2)).asInt == *((int*)("+-0")));
+
+		// 2 columns: pt = a*X + b*Y is toward X exactly when a > b, with no rounding on long runs
+		{
+			srand(11);
+			for(int i = 0; i < 50; ++i) {
+				TripletTriangle<int> edge("123"[i % 3], TripletTriangle<int>());
+				for(int j = rand() % 30; j > 0; --j) edge.operate((rand() & 1) ? 'l' : 'r');
+				typename TripletTriangle<int>::PointClassifier classifier(edge);
+				for(int a = 0; a <= 12; ++a) {
+					for(int b = 0; b <= 12; ++b) {
+						vec3 pt = edge[0] * a + edge[1] * b;
+						int expected = (a == b) ? SEX00 : (a > b) ? SEXX0 : SEXY0;
+						assert(edge.getSextant(pt) == expected && classifier.getSextant(pt) == expected);
+						assert(edge.getSextant(vec3(0, 0, 0) - pt) == expected);
+					}
+				}
+			}
+
+			TripletTriangle<int> run(vec3(1, 1, 499), vec3(0, 0, 1), vec3(0, 0, 0));
+			assert(run.getSextant(vec3(1, 1, 500)) == SEX00);
+			assert(run.getSextant(vec3(1, 1, 499)) == SEXX0 && run.getSextant(vec3(1, 1, 501)) == SEXY0);
+			TripletTriangle<int> big(vec3(40000, 39999, 1), vec3(39999, 39998, 1), vec3(0, 0, 0));
+			vec3 ctr = big.centroid();
+			assert(big.getSextant(ctr) == SEX00);
+			assert(big.getSextant(big[0] * 1000 + big[1] * 999) == SEXX0);
+			assert(big.getSextant(big[0] * 999 + big[1] * 1000) == SEXY0);
+		}
+
+		// the 2D continuation gives the same paths, best paths and counts as the node-by-node search
+		{
+			std::streambuf *cerrbuf = cerr.rdbuf(nullptr);
+			TripletSearch<int> jump, step;
+			jump.m_bVerbose = step.m_bVerbose = false;
+			step.m_bEdgeJump = false;
+			auto compare = [&](const vec3 &target, unsigned int maxDepth) {
+				jump.m_maxDepth = step.m_maxDepth = maxDepth;
+				assert(jump.search(target) == step.search(target));
+				assert(jump.m_paths == step.m_paths && jump.m_bestPath == step.m_bestPath);
+				assert(jump.m_countMaxDepth == step.m_countMaxDepth);
+			};
+			for(int x = 1; x <= 14; ++x) {
+				for(int y = 1; y <= 14; ++y) {
+					for(int z = 1; z <= 14; ++z) {
+						compare(vec3(x, y, z), 30);
+						compare(vec3(x, y, z), 5);
+					}
+				}
+			}
+			for(int k = 1; k < 300; k += 7) {
+				compare(vec3(1, k, 300 - k), 400);
+				compare(vec3(k, k, 300), 400);
+				compare(vec3(1, k, 300 - k), 100);
+			}
+			compare(vec3(1, 1, 500), 200);
+			compare(vec3(1, 1, 500), 1000);
+			assert(jump.search(vec3(1, 1, 500)) && jump.m_paths[0] == "{XY}" + string(499, 'l') + "!");
+			cerr.rdbuf(cerrbuf);
+		}
+
+		// test 1: generate all coprime triples up to a limit, and ensure a unique path exists to each
+
+		std::priority_queue<vec3> q;
+		// fill queue with all coprime triples up to a limit
+		int n = 7;
+		for(int x = 1; x <= n; ++x) {
+			for(int y = 1; y <= n; ++y) {
+				for(int z = 1; z <= n; ++z) {
+					vec3 p = { x, y, z };
+					if(p.isCoprime()) {
+						// symmetry is established... restrict to one sextant
+						//if(p.x <= p.y && p.y <= p.z) 
+                        {
+							q.push(p);
+						}
+					}
+				}
+			}
+		}
+
+
+		// findAll: the transposition table must list the same paths as the tree walk
+		{
+			TripletSearch<int> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 5;
+			s.m_operations = "xyzXYZ123bBcC";
+			for(vec3 p : { vec3(5, 4, 3), vec3(3, 1, 1), vec3(7, 2, 5) }) {
+				s.m_bFindAllTable = false;
+				s.findAll(p);
+				vector<string> tree = s.m_paths;
+				s.m_bFindAllTable = true;
+				s.findAll(p);
+				assert(s.m_paths == tree);
+				assert(s.countFindAllPaths() == tree.size());
+			}
+		}
+
+		// batch search must find the same paths, in input order
+		{
+			std::priority_queue<vec3> all(q);
+			vector<vec3> targets;
+			for(; !all.empty(); all.pop()) targets.push_back(all.top());
+
+			TripletSearch<int> batch;
+			batch.m_maxDepth = 8;
+			batch.m_bVerbose = false;
+			batch.searchBatch(targets);
+			assert(batch.m_batchPaths.size() == targets.size());
+			for(size_t i = 0; i < targets.size(); ++i) {
+				batch.search(targets[i]);
+				assert(batch.m_batchPaths[i] == (batch.m_paths.empty() ? string() : batch.m_paths[0]));
+			}
+		}
 
-	GrowthEnum m_growth = GrowthEnum::STOCHASTIC;
-	//static std::map<GrowthEnum, string> s_growth_enum_names;
+		while(q.size() > 0) {
+			vec3 p = q.top();
+			q.pop();
+			TripletSearch<int> search;
+			search.m_maxDepth = 8;
+			search.m_bVerbose = false;
+			//cout << "Searching for " << p << ": ";
 
-	// search results
-	vector<string> m_paths;
-	string m_bestPath;
-	int m_countMaxDepth;
-	int m_countMaxHeight;
-	int m_countMaxSum = 0;
-	int m_countCollision = 0;
-	int m_countDeadEnds;
-	bool m_bVerbose;
+			search.search(p);
 
-	// enumeration results
-	std::map<Triplet<I>, string> m_enumeration;
+			search.dumpSearchResults();
 
-	TripletSearch() 
-	{
-		m_targetRadius = 0;
-		m_maxDepth = 18;
-		m_maxHeight = 0x00010000;
-		m_maxNumEnumerationResults = 100000;
-		m_operations = "xyzXYZ123";// "468";// "456789";// "xyzXYZ";
-		m_bVerbose = true;
-	}
+			// run-length search must find the same path
+			if(search.m_paths.size() == 1)
+			{
+				string path = search.m_paths[0];
+				search.searchJump(p);
+				assert(search.m_paths.size() == 1);
+				assert(expandPath(search.m_paths[0]) == path);
+			}
+		}
 
-	bool findAll(const Triplet<I> &target)
-	{
-		m_target = target;
-		m_paths.clear();
-		m_bestPath.clear();
-		m_countMaxDepth = 0;
-		m_countMaxHeight = 0;
-		m_countDeadEnds = 0;
+		cout << "Testing streaming enumeration\n";
+		{
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 4;
+			s.m_maxHeight = 200;
+			s.enumerate();
+			auto collected = s.m_enumeration;
+
+			size_t count = 0;
+			s.enumerate([&](const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+				stringstream row;
+				writeEnumerationRow(row, p, path, suffix, depth);
+				assert(collected[p] == row.str());
+				++count;
+			});
+			assert(count == collected.size());
+			assert(s.m_enumeration.empty());
+
+			// height order: same triplets, in priority order
+			vector<Triplet<I>> ordered;
+			s.enumerateByHeight([&](const Triplet<I> &p, const TripletPath &, const char *, unsigned int) {
+				assert(collected.count(p));
+				assert(ordered.empty() || p < ordered.back());
+				ordered.push_back(p);
+			});
+			assert(ordered.size() == collected.size());
+		}
 
-		//cout << "--- Searching for " << m_target << " Ops: " << m_operations << " Depth: " << m_maxDepth << endl;
+		cout << "Testing parallel enumeration\n";
+		{
+			// the same rows, paths and counters as enumerate(), also where the result limit cuts it short
+			std::streambuf *cerrbuf = cerr.rdbuf(nullptr);
+			const unsigned int configs[][4] = { { 5, 300, 100000, 4 }, { 7, 1000, 5000, 4 }, { 6, 400, 37, 8 }, { 6, 400, 2, 3 }, { 0, 200, 100, 2 } };
+			for(auto &config : configs) {
+				TripletSearch<I> serial, parallel;
+				serial.m_bVerbose = parallel.m_bVerbose = false;
+				serial.m_maxDepth = parallel.m_maxDepth = config[0];
+				serial.m_maxHeight = parallel.m_maxHeight = config[1];
+				serial.m_maxNumEnumerationResults = parallel.m_maxNumEnumerationResults = config[2];
+				serial.enumerate();
+				parallel.enumerateParallel(config[3]);
+				assert(serial.m_enumeration == parallel.m_enumeration);
+				assert(serial.m_countMaxDepth == parallel.m_countMaxDepth);
+				assert(serial.m_countMaxHeight == parallel.m_countMaxHeight);
+				assert(serial.m_countDeadEnds == parallel.m_countDeadEnds);
+				assert(serial.m_depthCounts == parallel.m_depthCounts);
+			}
+			cerr.rdbuf(cerrbuf);
+		}
 
-		TripletTriangle<I> m;
-		findAllR(m, 0);
+		cout << "Testing symmetric enumeration\n";
+		{
+			std::streambuf *cerrbuf = cerr.rdbuf(nullptr);
+			const unsigned int configs[][2] = { { 0, 200 }, { 1, 200 }, { 4, 200 }, { 6, 60 }, { 7, 40 }, { 5, 2 } };
+			for(auto &config : configs) {
+				TripletSearch<I> full, symmetric;
+				full.m_bVerbose = symmetric.m_bVerbose = false;
+				full.m_maxDepth = symmetric.m_maxDepth = config[0];
+				full.m_maxHeight = symmetric.m_maxHeight = config[1];
+				symmetric.m_bEnumerateSymmetric = true;
+				full.enumerate();
+				symmetric.enumerate();
+
+				// same triplets and counters
+				assert(full.m_enumeration.size() == symmetric.m_enumeration.size());
+				for(auto &entry : full.m_enumeration) assert(symmetric.m_enumeration.count(entry.first));
+				assert(full.m_countMaxDepth == symmetric.m_countMaxDepth);
+				assert(full.m_countMaxHeight == symmetric.m_countMaxHeight);
+				assert(full.m_depthCounts == symmetric.m_depthCounts);
+
+				// each relabeled path leads to its triplet
+				size_t count = 0;
+				symmetric.enumerate([&](const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+					TripletTriangle<I> t;
+					path.forEach([&](char op) { t.operate(op); });
+					assert(path.size() == depth);
+					string s(suffix);
+					Triplet<I> expected = (s == "-ctr") ? t.centroid()
+						: (s == "-p01") ? t[0] + t[1] : (s == "-p12") ? t[1] + t[2] : (s == "-p02") ? t[0] + t[2]
+						: t[s[2] - '0'];
+					assert(expected == p);
+					++count;
+				});
+				assert(count == full.m_enumeration.size());
+			}
+			cerr.rdbuf(cerrbuf);
+		}
 
-		//cout << "" << m_paths.size() << " paths. Maxdepth: " << m_countMaxDepth << " Deadends: " << m_countDeadEnds << endl;
-		return (m_paths.size() > 0);
-	}
+		cout << "Testing sharded enumeration\n";
+		{
+			// rank() and unrank() are inverse, and number the nodes in path order
+			for(unsigned int depth = 0; depth <= 4; ++depth) {
+				TripletPath previous;
+				for(unsigned long long i = 0; i < TripletPath::rankCount(depth); ++i) {
+					TripletPath path = TripletPath::unrank(depth, i);
+					unsigned long long index = ~0ull;
+					assert(path.size() == depth && path.rank(index) && index == i);
+					assert(!i || previous < path);
+					previous = path;
+				}
+			}
+			unsigned long long index = 0;
+			assert(TripletPath("Zyx").rank(index) && index == 5 * 36 + 1 * 6 + 0);
+			assert(TripletPath::unrank(24, TripletPath::rankCount(24) - 1) == TripletPath(string(24, 'Z')));
+			assert(!TripletPath("x1y").rank(index) && !TripletPath("xl").rank(index));
+			TripletTriangle<I> node = TripletTriangle<I>::unrank(2, 6 + 5), expected = TripletTriangle<I>() + 'y' + 'Z';
+			assert(node[0] == expected[0] && node[1] == expected[1] && node[2] == expected[2] && node.path == expected.path);
+
+			std::streambuf *cerrbuf = cerr.rdbuf(nullptr);
+			// max depth, max height, split depth, shards, clip
+			const unsigned int configs[][5] = { { 5, 200, 2, 7, 0 }, { 4, 60, 3, 5, 0 }, { 6, 100, 1, 4, 0 }, { 2, 200, 3, 4, 0 }, { 5, 300, 2, 3, 1 }, { 3, 50, 0, 1, 0 } };
+			for(auto &config : configs) {
+				TripletSearch<I> full, shard;
+				full.m_bVerbose = shard.m_bVerbose = false;
+				full.m_maxDepth = shard.m_maxDepth = config[0];
+				full.m_maxHeight = shard.m_maxHeight = config[1];
+				if(config[4]) {
+					full.m_clip = shard.m_clip = TripletTriangle<I>(Triplet<I>(1, 0, 0), Triplet<I>(1, 1, 0), Triplet<I>(1, 1, 1));
+				}
+				full.enumerate();
+
+				// uneven shards, merged in order keeping each triplet's first row
+				std::map<Triplet<I>, string> merged;
+				std::map<unsigned int, unsigned int> depthCounts;
+				int countMaxDepth = 0, countMaxHeight = 0;
+				unsigned long long count = TripletPath::rankCount(config[2]);
+				for(unsigned int k = 0; k < config[3]; ++k) {
+					unsigned long long first = count * k * k / (config[3] * config[3]);
+					unsigned long long last = count * (k + 1) * (k + 1) / (config[3] * config[3]);
+					shard.m_depthCounts.clear();
+					shard.enumerate(config[2], first, last);
+					for(auto &entry : shard.m_enumeration) merged.insert(entry);
+					for(auto &entry : shard.m_depthCounts) depthCounts[entry.first] += entry.second;
+					countMaxDepth += shard.m_countMaxDepth;
+					countMaxHeight += shard.m_countMaxHeight;
+				}
+				assert(merged == full.m_enumeration);
+				assert(depthCounts == full.m_depthCounts);
+				assert(countMaxDepth == full.m_countMaxDepth);
+				assert(countMaxHeight == full.m_countMaxHeight);
+			}
+			cerr.rdbuf(cerrbuf);
+		}
 
-private:
-	bool findAllR(const TripletTriangle<I>& triangle, unsigned int depth) 
-	{
-		Triplet<I> ctr = triangle.centroid();
-		assert(ctr.isCoprime());
-		if(ctr == m_target) 
+		cout << "Testing multi-process enumeration\n";
+		{
+			std::streambuf *cerrbuf = cerr.rdbuf(nullptr);
+			TripletSearch<I> full;
+			full.m_bVerbose = false;
+			full.m_maxDepth = 6;
+			full.m_maxHeight = 150;
+			full.enumerate();
+			std::ostringstream expected;
+			for(auto &entry : full.m_enumeration) expected << entry.second << '\n';
+
+			// in-process workers; each worker's first launch dies after its first shard
+			ShardedEnumeration<I> driver;
+			driver.m_prefix = "EuclidTestShard";
+			driver.m_splitDepth = 3;
+			driver.m_numShards = 10;
+			driver.m_numWorkers = 4;
+			std::mutex lock;
+			std::map<string, bool> launched;
+			int failures = 0;
+			driver.m_launch = [&](const string &args) {
+				unsigned int first = 0, last = 0;
+				std::istringstream(args) >> first >> last;
+				TripletSearch<I> worker;
+				worker.m_bVerbose = false;
+				worker.m_maxDepth = full.m_maxDepth;
+				worker.m_maxHeight = full.m_maxHeight;
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					if(launched.insert({ args, true }).second) {
+						++failures;
+						driver.work(worker, first, first + 1);
+						return 1;
+					}
+				}
+				return driver.work(worker, first, last) ? 0 : 1;
+			};
+
+			// a shard left by an earlier run isn't taken for this run's
+			std::ofstream(driver.shardFile(0)) << "7,7,7,stale\n";
+			std::ostringstream merged;
+			size_t count = 0;
+			assert(driver.run(merged, &count));
+			assert(merged.str() == expected.str() && count == full.m_enumeration.size());
+			assert(failures == 4);
+
+			// a worker that never succeeds fails the run
+			driver.m_maxRestarts = 1;
+			driver.m_launch = [&](const string &) { return 1; };
+			driver.clear();
+			assert(!driver.run(merged));
+			driver.clear();
+			cerr.rdbuf(cerrbuf);
+		}
+
+		cout << "Testing checkpointed enumeration\n";
 		{
-			string path = triangle.path + "-ctr";
-			if(std::find(m_paths.begin(), m_paths.end(), path) == m_paths.end()) 
+			std::streambuf *cerrbuf = cerr.rdbuf(nullptr);
+			auto configure = [](TripletSearch<I> &s) {
+				s.m_bVerbose = false;
+				s.m_maxDepth = 6;
+				s.m_maxHeight = 150;
+			};
+			TripletSearch<I> full;
+			configure(full);
+			vector<Triplet<I>> expected;
+			full.enumerate([&](const Triplet<I> &p, const TripletPath &, const char *, unsigned int) { expected.push_back(p); });
+			full.m_depthCounts.clear();
+			full.enumerate();
+
+			// a streaming run that dies part way, checkpointing every 1024 nodes
+			const string file = "EuclidTestCheckpoint";
+			vector<Triplet<I>> streamed;
 			{
-				m_paths.push_back(path);
-				if(m_bVerbose) {
-					cout << "Found path: [" << path << "]\n";
+				TripletSearch<I> s;
+				configure(s);
+				s.m_checkpointFile = file;
+				s.m_checkpointSeconds = 0;
+				bool bThrown = false;
+				try {
+					s.enumerate([&](const Triplet<I> &p, const TripletPath &, const char *, unsigned int) {
+						if(streamed.size() == 5000) throw exception();
+						streamed.push_back(p);
+					});
 				}
+				catch(const exception &) {
+					bThrown = true;
+				}
+				assert(bThrown && s.checkpointedCount() > 0 && s.checkpointedCount() < 5000);
+				streamed.resize((size_t)s.checkpointedCount());
 			}
-			return true;
-		}
 
-		// compute the triangle edge midpoints
-		Triplet<I> p01 = triangle[0] + triangle[1];
-		Triplet<I> p12 = triangle[1] + triangle[2];
-		Triplet<I> p02 = triangle[0] + triangle[2];
+			// resumed streaming continues right after the watermark
+			{
+				TripletSearch<I> s;
+				configure(s);
+				s.m_checkpointFile = file;
+				s.m_bResume = true;
+				assert(s.enumerate([&](const Triplet<I> &p, const TripletPath &, const char *, unsigned int) { streamed.push_back(p); }));
+				assert(streamed == expected);
+				assert(s.m_countMaxDepth == full.m_countMaxDepth && s.m_countMaxHeight == full.m_countMaxHeight);
+				assert(s.m_depthCounts == full.m_depthCounts);
+			}
 
-		// is this step necessary? seems that every triple should eventually be a vertex..
-		if(p01 == m_target) { m_paths.push_back(triangle.path + "-p01"); return true; }
-		if(p12 == m_target) { m_paths.push_back(triangle.path + "-p12"); return true; }
-		if(p02 == m_target) { m_paths.push_back(triangle.path + "-p02"); return true; }
+			// resuming a finished run reloads it from the log
+			{
+				TripletSearch<I> s;
+				configure(s);
+				s.m_checkpointFile = file;
+				s.m_bResume = true;
+				assert(s.enumerate() && s.m_enumeration == full.m_enumeration);
+				assert(s.m_countMaxDepth == full.m_countMaxDepth && s.m_depthCounts == full.m_depthCounts);
+				s.m_maxDepth = 5;
+				assert(!s.enumerate());
+			}
 
-		if(depth >= m_maxDepth) {
-			++m_countMaxDepth;
-			return false;
+			// a collecting run resumed from a crash
+			{
+				TripletSearch<I> s;
+				configure(s);
+				s.m_checkpointFile = file;
+				s.m_checkpointSeconds = 0;
+				size_t count = 0;
+				try {
+					s.enumerate([&](const Triplet<I> &, const TripletPath &, const char *, unsigned int) {
+						if(++count == 20000) throw exception();
+					});
+				}
+				catch(const exception &) {
+				}
+				TripletSearch<I> resumed;
+				configure(resumed);
+				resumed.m_checkpointFile = file;
+				resumed.m_bResume = true;
+				assert(resumed.enumerate() && resumed.m_enumeration == full.m_enumeration);
+				assert(resumed.m_countMaxHeight == full.m_countMaxHeight && resumed.m_depthCounts == full.m_depthCounts);
+			}
+			::remove(file.c_str());
+			::remove((file + ".log").c_str());
+			cerr.rdbuf(cerrbuf);
 		}
 
-		if(!ctr.precedes(m_target)) {
-			++m_countDeadEnds;
-			return false;
+		cout << "Testing binary enumeration file\n";
+		{
+			std::streambuf *cerrbuf = cerr.rdbuf(nullptr);
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 6;
+			s.m_maxHeight = 150;
+			const string file = "EuclidTestEnumeration.bin";
+			assert(EnumerationFile<I>::write(file, s));
+			s.enumerate();
+
+			// the same rows in the same order as the CSV
+			EnumerationFile<I> enumeration;
+			assert(enumeration.open(file));
+			assert(enumeration.size() == s.m_enumeration.size() && enumeration.maxDepth() == 6 && enumeration.maxHeight() == 150);
+			size_t i = 0;
+			for(auto &entry : s.m_enumeration) {
+				std::ostringstream row;
+				enumeration.writeRow(row, i);
+				assert(entry.first == enumeration.triplet(i) && row.str() == entry.second);
+				assert(enumeration.find(entry.first) == i);
+				++i;
+			}
+			i = 0;
+			enumeration.forEach([&](const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+				std::ostringstream row;
+				TripletSearch<I>::writeEnumerationRow(row, p, path, suffix, depth);
+				assert(row.str() == s.m_enumeration[p] && i++ == enumeration.find(p));
+			});
+
+			TripletPath path;
+			assert(enumeration.lookup(Triplet<I>(5, 4, 3), path));
+			assert(s.m_enumeration[Triplet<I>(5, 4, 3)].find("\"" + path.str()) != string::npos);
+			assert(!enumeration.lookup(Triplet<I>(2, 2, 2), path) && enumeration.find(Triplet<I>(1000, 1, 1)) == enumeration.size());
+			enumeration.close();
+
+			// truncated files don't open
+			{
+				std::ifstream in(file, std::ios::binary);
+				string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+				in.close();
+				std::ofstream(file, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size() - 1);
+			}
+			assert(!enumeration.open(file));
+			assert(enumeration.size() == 0 && enumeration.maxDepth() == 0 && enumeration.maxHeight() == 0);
+
+			// depths past 16 bits are kept
+			vector<typename EnumerationFile<I>::Record> records(1);
+			records[0].p = Triplet<I>(5, 4, 3);
+			records[0].path.assign("xyZ");
+			records[0].suffix = "-ctr";
+			records[0].depth = 70000;
+			assert(EnumerationFile<I>::write(file, records, 70000, 150));
+			assert(enumeration.open(file) && enumeration.size() == 1);
+			assert(enumeration.depth(0) == 70000 && enumeration.maxDepth() == 70000 && enumeration.path(0) == records[0].path);
+			enumeration.close();
+			::remove(file.c_str());
+			cerr.rdbuf(cerrbuf);
 		}
 
-		const char *ops = m_operations.data();
-		for(; *ops; ++ops) {
-			//TripletTriangle<I> m2(*ops, triangle);
-			findAllR(triangle + *ops, depth + 1);
+		cout << "Testing path table\n";
+		{
+			// rank() numbers the positive triplets by height, then x, then y
+			unsigned long long count = 0;
+			for(int h = 3; h <= 30; ++h) {
+				for(int x = 1; x <= h - 2; ++x) {
+					for(int y = 1; x + y <= h - 1; ++y) {
+						assert(PathTable<I>::rank(Triplet<I>(x, y, h - x - y)) == count++);
+					}
+				}
+				assert(PathTable<I>::tableSize(h) == count);
+			}
+
+			const string file = "EuclidTestPaths.tbl";
+			const unsigned int height = 60;
+			assert(PathTable<I>::build(file, height));
+			PathTable<I> table;
+			assert(table.open(file) && table.maxHeight() == height);
+
+			// the same results as search(), also where m_maxDepth cuts the search short
+			TripletSearch<I> searched, looked;
+			searched.m_bVerbose = looked.m_bVerbose = false;
+			looked.m_pPathTable = &table;
+			for(unsigned int maxDepth : { 1050u, 6u }) {
+				searched.m_maxDepth = looked.m_maxDepth = maxDepth;
+				for(int h = 3; h <= (int)height + 5; ++h) {
+					for(int x = 1; x <= h - 2; ++x) {
+						for(int y = 1; x + y <= h - 1; ++y) {
+							Triplet<I> p(x, y, h - x - y);
+							if(!p.isCoprime()) continue;
+							assert(searched.search(p) == looked.search(p));
+							assert(searched.m_paths == looked.m_paths && searched.m_bestPath == looked.m_bestPath);
+							assert(searched.m_countMaxDepth == looked.m_countMaxDepth && searched.m_countDeadEnds == looked.m_countDeadEnds);
+						}
+					}
+				}
+			}
+
+			string path;
+			unsigned int ops = 0;
+			searched.search(Triplet<I>(5, 4, 3));
+			assert(table.lookup(Triplet<I>(5, 4, 3), path, ops) && path == searched.m_paths[0] && ops == 4);
+			assert(!table.lookup(Triplet<I>(2, 2, 2), path, ops) && !table.lookup(Triplet<I>(60, 1, 1), path, ops));
+			assert(!table.lookup(Triplet<I>(0, 1, 1), path, ops));
+
+			// coordinates whose sum overflows int must miss the table, not wrap into it
+			const Triplet<I> huge(2147483647, 2147483647, 2);
+			assert(!table.lookup(huge, path, ops));
+			searched.m_maxDepth = looked.m_maxDepth = 40;
+			assert(searched.search(huge) == looked.search(huge) && searched.m_paths == looked.m_paths);
+			table.close();
+			::remove(file.c_str());
 		}
 
-		return false;
-	}
+		cout << "Testing wide arithmetic\n";
+		{
+			// triple products near 1e15 overflow int, but not Wide<int>
+			vec3 a(100000, 1, 1), b(1, 100000, 1), c(1, 1, 100000);
+			assert(leftOf(a, b, c) == 1);
+			assert(leftOf(b, a, c) == -1);
+			assert(TripletTriangle<int>(a, b, c).determinant() == 999999999700002LL);
+			assert(vec3(100000, 100000, 1).lengthSq() == 20000000001LL);
+
+			// triple products near 2^90 overflow long long too; leftOf() must still agree with leftOfExact()
+			vec3 big[3] = { vec3(1 << 30, 1, 1), vec3(1, 1 << 30, 1), vec3(1, 1, 1 << 30) };
+			assert(leftOf(big[0], big[1], big[2]) == 1);
+			srand(1);
+			auto random29 = []() { return (rand() & 0x7fff) << 14 | (rand() & 0x3fff); };
+			for(int i = 0; i < 1000; ++i) {
+				vec3 u(random29(), random29(), random29());
+				vec3 v(random29(), random29(), random29());
+				vec3 w = u + v;
+				int offset = i % 3 - 1;		// collinear, or just off the line
+				w.x += offset;
+				assert(leftOf(u, v, w) == leftOfExact(u, v, w));
+				assert(!offset == !leftOf(u, v, w));
+			}
 
-public:
-	const int ERROR_INTERNAL = -9;
+			// the limb product agrees with the wide one, also for mixed signs
+			for(int i = 0; i < 1000; ++i) {
+				vec3 u(random29() - (1 << 28), random29(), -random29());
+				vec3 v(random29(), random29() - (1 << 28), random29());
+				vec3 w(-random29(), random29(), random29() - (1 << 28));
+				assert(leftOfLimbs(u, v, w) == leftOfExact(u, v, w));
+			}
 
-	// sextant tree search. each recursion drills down into 1/6 of the parent search area.
-    // Uses sextant cascade operators (xyzXYZ) and dimensional collapse (123). ignores m_operations.
-	int search(const Triplet<I> &target)
-	{
-		m_target = target;
-		m_paths.clear();
-		m_bestPath.clear();
-		m_countMaxDepth = 0;
-		m_countMaxHeight = 0;
-		m_countDeadEnds = 0;
+			// 64-bit coordinates beyond Wide<long long>::maxExact: with w = u + v + offset * (1,0,0),
+			// the triple product is offset * (u.y * v.z - u.z * v.y)
+			typedef Triplet<long long> vec3ll;
+			auto random59 = [&]() { return ((long long)random29() << 30) + random29(); };
+			for(int i = 0; i < 1000; ++i) {
+				vec3ll u(random59(), random59(), random59());
+				vec3ll v(random59(), random59(), random59());
+				vec3ll w = u + v;
+				int offset = i % 3 - 1;
+				w.x += offset;
+				assert(leftOf(u, v, w) == leftOfExact(u, v, w));
+				assert(!offset == !leftOf(u, v, w));
+#ifdef EUCLID_INT128
+				assert(leftOf(u, v, w) == offset * sign((int128)u.y * v.z - (int128)u.z * v.y));
+
+				// and 128-bit coordinates near 2^120, whose minors overflow int128
+				typedef Triplet<int128> vec3x;
+				vec3x U((int128)u.x << 61, (int128)u.y << 61, (int128)u.z << 61);
+				vec3x V((int128)v.x << 61, (int128)v.y << 61, (int128)v.z << 61);
+				vec3x W = U + V;
+				W.x += offset;
+				assert(leftOf(U, V, W) == leftOfExact(U, V, W));
+				assert(leftOf(U, V, W) == offset * sign((int128)u.y * v.z - (int128)u.z * v.y));
+#endif
+			}
 
-		if(m_bVerbose) 
+			// coordinates above 2^16: products of two coordinates overflow int
+			TripletSearch<int> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 200;
+			vec3 p(100003, 61803, 38197);
+			s.search(p);
+			assert(s.m_paths.size() == 1);
+			string path = s.m_paths[0];
+			s.searchJump(p);
+			assert(s.m_paths.size() == 1 && expandPath(s.m_paths[0]) == path);
+
+#ifdef EUCLID_INT128
+			// run lengths near 1e10 overflow long long in searchJump() without widening
+			TripletSearch<long long> s64;
+			TripletSearch<int128> s128;
+			s64.m_bVerbose = s128.m_bVerbose = false;
+			s64.searchJump(Triplet<long long>(10000000019LL, 10000000007LL, 3));
+			s128.searchJump(Triplet<int128>(10000000019LL, 10000000007LL, 3));
+			assert(s64.m_paths.size() == 1 && s64.m_paths == s128.m_paths);
+#endif
+		}
+
+		cout << "Testing batch point classification\n";
 		{
-			cout << "--- Sextant search --- Target: " << m_target 
-				<< " Growth: " << GrowthEnumString(m_growth) 
-				<< " Depth: " << m_maxDepth << " ---\n";
+			// batch results must match the per-point tests, with and without the AVX2 kernel
+			srand(2);
+			vector<int> xs, ys, zs;
+			for(int i = 0; i < 1003; ++i) {
+				int scale = (i % 97 == 0) ? (1 << 30) : 64;		// some points beyond the kernel's range
+				xs.push_back(rand() % scale);
+				ys.push_back(rand() % scale);
+				zs.push_back(rand() % scale + 1);
+			}
+			TripletTriangle<int> tris[] = { TripletTriangle<int>(), TripletTriangle<int>('x', TripletTriangle<int>()),
+				TripletTriangle<int>('1', TripletTriangle<int>()), TripletTriangle<int>(vec3(15, 10, 8), vec3(6, 4, 3), vec3(25, 17, 14)) };
+			for(auto &tri : tris) {
+				for(int simd = 0; simd <= 1; ++simd) {
+					typename TripletTriangle<int>::PointClassifier classifier(tri);
+					classifier.m_bAllowSimd = !!simd;
+					vector<SexClass> sex(xs.size());
+					std::unique_ptr<bool[]> inside(new bool[xs.size()]);
+					classifier.getSextants(xs.data(), ys.data(), zs.data(), xs.size(), sex.data());
+					classifier.containsPoints(xs.data(), ys.data(), zs.data(), xs.size(), inside.get());
+					for(size_t i = 0; i < xs.size(); ++i) {
+						vec3 p(xs[i], ys[i], zs[i]);
+						assert(sex[i].asInt == tri.getSextant(p).asInt);
+						assert(inside[i] == tri.containsPoint(p));
+					}
+				}
+			}
+
+			// a large triangle whose planes are too large for dot products in Wide<int>, with points
+			// on and just off its edges and medians, and far from them
+			TripletTriangle<int> big(vec3(1 << 20, 3, 1), vec3(2, 1 << 20, 5), vec3(7, 1, 1 << 20));
+			vector<vec3> pts;
+			vec3 ctr = big.centroid();
+			for(int k = 0; k < 3; ++k) {
+				vec3 ends[2][2] = { { big[k], big[(k + 1) % 3] }, { ctr, big[k] } };
+				for(auto &e : ends) {
+					for(int d = -1; d <= 1; ++d) {
+						vec3 p = e[0] + e[1];
+						p.x += d;
+						pts.push_back(p);
+						p.y -= d;
+						pts.push_back(p);
+					}
+				}
+			}
+			auto random30 = []() { return (rand() & 0x7fff) << 15 | (rand() & 0x7fff); };
+			for(int i = 0; i < 200; ++i) {
+				pts.push_back(vec3(random30(), random30(), random30()));
+			}
+			typename TripletTriangle<int>::PointClassifier classifier(big);
+			for(auto &p : pts) {
+				assert(classifier.getSextant(p).asInt == big.getSextant(p).asInt);
+				assert(classifier.containsPoint(p) == big.containsPoint(p));
+			}
+			for(int simd = 0; simd <= 1; ++simd) {
+				classifier.m_bAllowSimd = !!simd;
+				TripletBlock<int> block(pts);
+				vector<SexClass> sex(block.size());
+				std::unique_ptr<bool[]> inside(new bool[block.size()]);
+				classifier.getSextants(block, sex.data());
+				classifier.containsPoints(block, inside.get());
+				for(size_t i = 0; i < pts.size(); ++i) {
+					assert(sex[i].asInt == big.getSextant(pts[i]).asInt);
+					assert(inside[i] == big.containsPoint(pts[i]));
+				}
+			}
 		}
 
-		TripletTriangle<I> m;
-		bool found = (searchR(m, 0) > 0);
+		cout << "Testing triplet blocks\n";
+		{
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 4;
+			s.m_maxHeight = 200;
+			TripletBlock<I> block;
+			s.enumerate(block);
+			vector<Triplet<I>> streamed;
+			s.enumerate([&](const Triplet<I> &p, const TripletPath &, const char *, unsigned int) {
+				streamed.push_back(p);
+			});
+			assert(block.size() == streamed.size());
+			assert((size_t)block.x() % TripletBlock<I>::ALIGNMENT == 0 && (size_t)block.z() % TripletBlock<I>::ALIGNMENT == 0);
+
+			vector<Triplet<I>> round;
+			TripletBlock<I>(streamed).toTriplets(round);
+			assert(round == streamed);
+
+			vector<I> sums(block.size());
+			vector<float> px(block.size()), py(block.size()), pz(block.size());
+			block.sums(sums.data());
+			block.project(px.data(), py.data(), pz.data());
+			for(size_t i = 0; i < block.size(); ++i) {
+				assert(block[i] == streamed[i]);
+				assert(sums[i] == streamed[i].sum());
+				vector<float> p = streamed[i].project();
+				assert(px[i] == p[0] && py[i] == p[1] && pz[i] == p[2]);
+			}
 
-		//cout << endl;
-		std::sort(m_paths.begin(), m_paths.end());
-		return (m_paths.size() > 0);
+			// enumerated triplets are coprime; scaled copies are not
+			size_t n = block.size();
+			for(size_t i = 0; i < n; ++i) block.push_back(block[i] + block[i]);
+			assert(block.filterCoprime() == n);
+			for(size_t i = 0; i < n; ++i) assert(block[i] == streamed[i]);
+		}
+
+		cout << "Testing merge coprimality\n";
+
+		for(int i = 0; i < 100; ++i) {
+			TripletTriangle<I> x;
+			for(int j = 0; j < 50; ++j) {
+				int fromCol = rand() % 3;
+				int toCol = (fromCol + 1+rand() % 1) % 3;
+				x.merge(fromCol, toCol);
+				auto ctr = x.centroid();
+				int g = gcdBinary(&ctr.x, 3);
+				ASSERT(ctr.isCoprime(), string("not coprime: ") +std::to_string(g)+" "+ std::to_string(x));
+			}
+		}
+
+		cout << "--- Completed tests ---\n>";
+		char dummy;
+		cin >> dummy;
+
+		return 1;
 	}
 
-private:
-	int searchR(const TripletTriangle<I> &triangle, unsigned int depth) 
+	//
+	//	Benchmarks
+	//	compares alternative implementations of the same operation. Run with /b
+	//
+	static void runBenchmarks()
 	{
-		if(triangle.isZero())
+		// enumerate() dumps every intersecting triangle to cerr
+		std::streambuf *cerrbuf = cerr.rdbuf(nullptr);
+
+		cout << "--- Traversal: recursive vs. explicit stack ---\n";
+		for(int recursive = 1; recursive >= 0; --recursive)
 		{
-			return 0;
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_bRecursive = !!recursive;
+			s.m_bFindAllTable = false;
+			const char *label = recursive ? "recursive" : "stack";
+
+			s.m_maxDepth = 6;
+			s.m_maxHeight = 0x7fffffff;
+			s.m_maxNumEnumerationResults = 0x7fffffff;
+			string name = string("enumerate depth 6, ") + label;
+			benchmark(name.c_str(), 3, [&]() { s.enumerate(); });
+
+			s.m_maxDepth = 7;
+			name = string("findAll [5,4,3] depth 7, ") + label;
+			benchmark(name.c_str(), 3, [&]() { s.findAll(Triplet<I>(5, 4, 3)); });
+
+			s.m_maxDepth = 1050;
+			name = string("search x1000 depth 1050, ") + label;
+			benchmark(name.c_str(), 3, [&]() {
+				for(int i = 1; i <= 1000; ++i) {
+					s.search(Triplet<I>(1000, i, 1000 - i + 1));
+				}
+			});
 		}
 
-		Triplet<I> ctr = triangle.centroid();
-		assert(ctr.isCoprime());
-		//if(!(ctr.isCoprime())) {
-		//	cerr << "\n -- TEST FAILED: \n" << triangle << endl;
-		//	return ERROR_INTERNAL;
-		//}
+		cout << "--- Enumeration: full tree vs. x <= y <= z sextant ---\n";
+		for(int symmetric = 0; symmetric <= 1; ++symmetric)
+		{
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_bEnumerateSymmetric = !!symmetric;
+			s.m_maxDepth = 7;
+			s.m_maxHeight = 0x7fffffff;
+			s.m_maxNumEnumerationResults = 0x7fffffff;
+			string name = string("enumerate depth 7, ") + (symmetric ? "symmetric" : "full");
+			benchmark(name.c_str(), 3, [&]() { s.enumerate(); });
+			size_t count = 0;
+			name = string("enumerate depth 7, streaming, ") + (symmetric ? "symmetric" : "full");
+			benchmark(name.c_str(), 3, [&]() { s.enumerate([&](const Triplet<I> &, const TripletPath &, const char *, unsigned int) { ++count; }); });
+		}
 
-		if(!triangle.containsPoint(m_target)) 
+		cout << "--- Enumeration: checkpoint overhead ---\n";
+		for(int checkpoint = 0; checkpoint <= 2; ++checkpoint)
 		{
-			cerr << ".. Rejecting[" << depth << "]..\n";
-			cerr << triangle;
-			return 0;
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 7;
+			s.m_maxHeight = 0x7fffffff;
+			s.m_maxNumEnumerationResults = 0x7fffffff;
+			if(checkpoint) {
+				s.m_checkpointFile = "EuclidBenchmarkCheckpoint";
+				s.m_checkpointSeconds = (checkpoint == 1) ? 60 : 0;
+			}
+			const char *labels[] = { "none", "every 60 s", "every 1024 nodes" };
+			string name = string("enumerate depth 7, streaming, checkpoints: ") + labels[checkpoint];
+			size_t count = 0;
+			benchmark(name.c_str(), 3, [&]() { s.enumerate([&](const Triplet<I> &, const TripletPath &, const char *, unsigned int) { ++count; }); });
 		}
+		::remove("EuclidBenchmarkCheckpoint");
+		::remove("EuclidBenchmarkCheckpoint.log");
 
-		if( !triangle[0].precedes(m_target) &&
-			!triangle[1].precedes(m_target) &&
-			!triangle[2].precedes(m_target)) 
+		cout << "--- Enumeration lookup: CSV vs. mapped EnumerationFile ---\n";
 		{
-			cerr << " ** wrong turn somewhere. no vertex precedes " << m_target << endl;
-			cerr << triangle;
-			return 0;
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 7;
+			s.m_maxHeight = 0x7fffffff;
+			s.m_maxNumEnumerationResults = 0x7fffffff;
+			EnumerationFile<I>::write("EuclidBenchmark.bin", s);
+			s.enumerate();
+			{
+				std::ofstream csv("EuclidBenchmark.csv");
+				for(auto &entry : s.m_enumeration) csv << entry.second << '\n';
+			}
+			vector<Triplet<I>> keys;
+			for(auto &entry : s.m_enumeration) keys.push_back(entry.first);
+			srand(1);
+			for(size_t i = keys.size(); i > 1; --i) std::swap(keys[i - 1], keys[((size_t)rand() << 15 | rand()) % i]);
+			keys.resize((std::min)(keys.size(), (size_t)1000000));
+
+			std::map<Triplet<I>, string> parsed;
+			benchmark("load CSV into std::map", 1, [&]() {
+				std::ifstream csv("EuclidBenchmark.csv");
+				string line;
+				while(std::getline(csv, line)) {
+					Triplet<I> p;
+					std::istringstream(line) >> p;
+					parsed.emplace(p, line);
+				}
+			});
+			EnumerationFile<I> enumeration;
+			benchmark("open EnumerationFile", 1, [&]() { enumeration.open("EuclidBenchmark.bin"); });
+
+			size_t found = 0;
+			benchmark("lookup path x1M, std::map", 3, [&]() {
+				for(auto &p : keys) found += parsed.find(p)->second.size();
+			});
+			benchmark("lookup path x1M, EnumerationFile", 3, [&]() {
+				TripletPath path;
+				for(auto &p : keys) found += enumeration.lookup(p, path);
+			});
+			enumeration.close();
+			::remove("EuclidBenchmark.bin");
+			::remove("EuclidBenchmark.csv");
 		}
 
-		if(	   ctr.x > m_target.x
-			|| ctr.y > m_target.y
-			|| ctr.z > m_target.z)
+		cout << "--- search(): descent vs. path table ---\n";
 		{
-			cerr << " ** missed the exit somewhere. ctr=" << ctr << " > target=" << m_target << endl;
-			cerr << triangle;
-			return 0;
+			const unsigned int height = 200;
+			benchmark("PathTable::build() height 200", 1, [&]() { PathTable<I>::build("EuclidBenchmark.tbl", height); });
+			PathTable<I> table;
+			benchmark("PathTable::open()", 1, [&]() { table.open("EuclidBenchmark.tbl"); });
+
+			vector<Triplet<I>> targets;
+			for(unsigned int h = 150; h <= height; ++h) {
+				for(unsigned int x = 1; x + 2 <= h; ++x) {
+					for(unsigned int y = 1; x + y + 1 <= h; ++y) {
+						Triplet<I> p(I(x), I(y), I(h - x - y));
+						if(p.isCoprime()) targets.push_back(p);
+					}
+				}
+			}
+			for(int useTable = 0; useTable <= 1; ++useTable) {
+				TripletSearch<I> s;
+				s.m_bVerbose = false;
+				s.m_maxDepth = 1050;
+				if(useTable) s.m_pPathTable = &table;
+				string name = "search() heights 150-200, " + std::to_string(targets.size()) + " targets, " + (useTable ? "table" : "descent");
+				benchmark(name.c_str(), 1, [&]() {
+					for(auto &p : targets) s.search(p);
+				});
+			}
+			table.close();
+			::remove("EuclidBenchmark.tbl");
 		}
 
-		//if(m_bVerbose)
-		//{
-		//	cout << ".. Searching[" << depth << "].. " << path << "\n";
-		//	cout << triangle;
-		//}
+		cout << "--- findAll: tree walk vs. transposition table ---\n";
+		for(int table = 0; table <= 1; ++table)
+		{
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_bFindAllTable = !!table;
+			s.m_operations = "xyzXYZ123bBcC";
+			s.m_maxDepth = 6;
+			string name = string("findAll [5,4,3] depth 6, xyzXYZ123bBcC, ") + (table ? "table" : "tree");
+			benchmark(name.c_str(), 1, [&]() { s.findAll(Triplet<I>(5, 4, 3)); });
+		}
+		{
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_bListPaths = false;
+			s.m_maxDepth = 12;
+			unsigned long long count = 0;
+			benchmark("findAll [5,4,3] depth 12, DAG only", 1, [&]() {
+				s.findAll(Triplet<I>(5, 4, 3));
+				count = s.countFindAllPaths();
+			});
+			printf("  %-40s %10llu paths, %zu nodes\n", "", count, s.m_findAllNodes.size());
+		}
 
-		//bool found = false;		
+		cout << "--- Search: search() loop vs. searchBatch() ---\n";
+		for(int spread = 10; spread <= 1000; spread *= 10)
+		{
+			// 10000 targets around [5000,3000,2000]; a tighter spread shares more of the descent
+			vector<Triplet<I>> targets;
+			srand(1);
+			while(targets.size() < 10000) {
+				Triplet<I> p(5000 + rand() % spread, 3000 + rand() % spread, 2000 + rand() % spread);
+				if(p.isCoprime()) targets.push_back(p);
+			}
 
-		/* // method 1		
-		// check vertices?
-		if(triangle[0] == m_target) { found = true; m_paths.push_back(path + "-vX"); return 1; }
-		if(triangle[1] == m_target) { found = true; m_paths.push_back(path + "-vY"); return 1; }
-		if(triangle[2] == m_target) { found = true; m_paths.push_back(path + "-vZ"); return 1; }
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 20000;
+			string name = "search() x10000, spread " + std::to_string(spread);
+			double loop = benchmark(name.c_str(), 1, [&]() {
+				for(auto &p : targets) s.search(p);
+			});
+			name = "searchBatch() x10000, spread " + std::to_string(spread);
+			double batch = benchmark(name.c_str(), 1, [&]() { s.searchBatch(targets); });
+			printf("  %-40s %10.0f targets/s vs. %.0f\n", "batch throughput", targets.size() * 1000.0 / batch, targets.size() * 1000.0 / loop);
+		}
 
-		//// compute the triangle edge midpoints
-		//Triplet<I> p01 = triangle[0] + triangle[1];
-		//Triplet<I> p12 = triangle[1] + triangle[2];
-		//Triplet<I> p02 = triangle[0] + triangle[2];
+		cout << "--- Enumeration: serial vs. parallel ---\n";
+		{
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 6;
+			s.m_maxHeight = 0x7fffffff;
+			s.m_maxNumEnumerationResults = 0x7fffffff;
+			benchmark("enumerate depth 6, serial", 3, [&]() { s.enumerate(); });
+
+			unsigned int numThreads = (std::max)(1u, std::thread::hardware_concurrency());
+			for(unsigned int threads = 1; threads <= numThreads; threads *= 2) {
+				string name = "enumerate depth 6, " + std::to_string(threads) + " threads";
+				benchmark(name.c_str(), 3, [&]() { s.enumerateParallel(threads); });
+			}
+		}
 
-		//if(p01 == m_target) { found = true; m_paths.push_back(path + "-p01"); }
-		//if(p12 == m_target) { found = true; m_paths.push_back(path + "-p12"); }
-		//if(p02 == m_target) { found = true; m_paths.push_back(path + "-p02"); }
-*/
+		cout << "--- Integer width: int vs. long long vs. int128 ---\n";
+		benchmarkWidth<int>("int");
+		benchmarkWidth<long long>("long long");
+#ifdef EUCLID_INT128
+		benchmarkWidth<int128>("int128");
+#endif
 
-		SexClass sextant = triangle.getSextant(m_target);
+		cout << "--- leftOf: exact vs. adaptive ---\n";
+		benchmarkLeftOf<int>("int");
+		benchmarkLeftOf<long long>("long long");
 
-		if(m_bVerbose)
+		cout << "--- Sextant tree to depth 8: op switch vs. table vs. compile-time ops ---\n";
 		{
-			cout << "Sextant: " << sextant.asChar << endl;
+			TripletTriangle<I> root;
+			auto compiled = TripletOpTable<I>::compile("xyzXYZ");
+			long long bySwitch = 0, byTable = 0, byAlphabet = 0;
+			benchmark("apply(char)", 3, [&]() { bySwitch = sumTree(root, 8, nullptr); });
+			benchmark("TripletOpTable::compile()", 3, [&]() { byTable = sumTree(root, 8, &compiled); });
+			benchmark("SextantOps::traverse()", 3, [&]() {
+				byAlphabet = 0;
+				SextantOps::traverse(root, 8, [&](const TripletTriangle<I> &t, unsigned int) {
+					byAlphabet += t.centroid().x;
+					return true;
+				});
+			});
+			assert(bySwitch == byTable && bySwitch == byAlphabet);
 		}
 
-		// method 2
-		if(triangle.numColumns() == 1)
+		cout << "--- Replaying 100k paths of 24 sextant ops: per op vs. by block ---\n";
 		{
-			if(ctr == m_target)
-			{
-				//found = true;
-				if(m_bVerbose)
-					cout << "FOUND: " << triangle.path << "." << endl;
-
-				m_paths.push_back(triangle.path + ".");
-				return 1;
+			typedef long long L;
+			vector<TripletPath> paths(100000);
+			srand(1);
+			for(auto &path : paths) {
+				for(int j = 0; j < 24; ++j) path.push_back("xyzXYZ"[rand() % 6]);
 			}
-
-			cerr << " ** unknown error. single column miss" << endl;
-			cerr << triangle;
-			return 0;
+			vector<TripletTriangle<L>> expected(paths.size()), out;
+
+			benchmark("operate() per op", 3, [&]() {
+				for(size_t i = 0; i < paths.size(); ++i) {
+					TripletTriangle<L> &t = expected[i];
+					t.reset();
+					t.path.clear();
+					paths[i].forEach([&](char op) { t.operate(op); });
+				}
+			});
+			for(int k = 2; k <= 5; ++k) {
+				TripletPathEvaluator<L> evaluator(k);
+				string name = "evaluate(), " + std::to_string(k) + "-op blocks";
+				benchmark(name.c_str(), 3, [&]() {
+					out.resize(paths.size());
+					for(size_t i = 0; i < paths.size(); ++i) out[i] = evaluator.evaluate(paths[i]);
+				});
+				for(size_t i = 0; i < paths.size(); ++i) assert(out[i].centroid() == expected[i].centroid());
+			}
+			TripletPathEvaluator<L> evaluator;
+			benchmark("evaluate(paths), 4-op blocks", 3, [&]() { evaluator.evaluate(paths, out); });
+			std::sort(paths.begin(), paths.end());
+			benchmark("evaluate(paths), 4-op blocks, sorted", 3, [&]() { evaluator.evaluate(paths, out); });
 		}
 
-		int foundCount = 0;
+		cout << "--- Point classification: per point vs. batch ---\n";
+		{
+			// 1M points in [0,10000)^3 against a 3-column triangle at depth 3
+			const size_t n = 1000000;
+			vector<I> xs(n), ys(n), zs(n);
+			srand(1);
+			for(size_t i = 0; i < n; ++i) {
+				xs[i] = I(rand() % 10000);
+				ys[i] = I(rand() % 10000);
+				zs[i] = I(rand() % 10000 + 1);
+			}
+			TripletTriangle<I> tri('x', TripletTriangle<I>('y', TripletTriangle<I>('z', TripletTriangle<I>())));
+			typename TripletTriangle<I>::PointClassifier classifier(tri);
+			vector<SexClass> sex(n);
+
+			benchmark("getSextant() x1M", 3, [&]() {
+				for(size_t i = 0; i < n; ++i) sex[i] = classifier.getSextant(Triplet<I>(xs[i], ys[i], zs[i]));
+			});
+			vector<SexClass> expected(sex);
+			for(int simd = 0; simd <= 1; ++simd) {
+				classifier.m_bAllowSimd = !!simd;
+				benchmark(simd ? "getSextants() x1M, AVX2" : "getSextants() x1M, scalar", 3, [&]() {
+					classifier.getSextants(xs.data(), ys.data(), zs.data(), n, sex.data());
+				});
+				for(size_t i = 0; i < n; ++i) assert(sex[i] == expected[i].asInt);
+			}
+			printf("  %-40s %10s\n", "AVX2 available", cpuHasAvx2() ? "yes" : "no");
+		}
 
-		// method 1
+		cout << "--- Point classification: 2 columns ---\n";
+		{
+			// points along the long run to [1, 1, 500]
+			TripletTriangle<I> run(Triplet<I>(1, 1, 499), Triplet<I>(0, 0, 1), Triplet<I>(0, 0, 0));
+			typename TripletTriangle<I>::PointClassifier classifier(run);
+			vector<Triplet<I>> points(1000000);
+			srand(1);
+			for(auto &p : points) p = run[0] * I(rand() % 1000) + run[1] * I(rand() % 1000);
+			int count = 0;
+			benchmark("getSextant() x1M, [1, 1, 499] edge", 3, [&]() {
+				count = 0;
+				for(auto &p : points) count += (run.getSextant(p) == SEXX0);
+			});
+			benchmark("PointClassifier::getSextant() x1M, same", 3, [&]() {
+				count = 0;
+				for(auto &p : points) count += (classifier.getSextant(p) == SEXX0);
+			});
+
+			TripletSearch<I> s;
+			s.m_bVerbose = false;
+			s.m_maxDepth = 1050;
+			for(int jump = 0; jump <= 1; ++jump) {
+				s.m_bEdgeJump = !!jump;
+				const char *label = jump ? ", searchEdge()" : ", per node";
+				string name = string("search [1, k, 1000 - k]") + label;
+				benchmark(name.c_str(), 3, [&]() {
+					for(int k = 1; k < 1000; ++k) s.search(Triplet<I>(1, I(k), I(1000 - k)));
+				});
+				name = string("search [k, k, 1000]") + label;
+				benchmark(name.c_str(), 3, [&]() {
+					for(int k = 1; k < 1000; ++k) s.search(Triplet<I>(I(k), I(k), 1000));
+				});
+			}
+		}
 
-        //  if target is found, skip the dimensional collapses
-		if(sextant.asInt == SEX00) 
-        {
-			m_paths.push_back(triangle.path + "!");
-			return 1;
-		}//*/
+		cout << "--- Bulk ops: vector<Triplet> vs. TripletBlock ---\n";
+		{
+			const size_t n = 1000000;
+			vector<Triplet<I>> triplets(n);
+			srand(1);
+			for(auto &p : triplets) p.set(I(rand() % 10000), I(rand() % 10000), I(rand() % 10000 + 1));
+			TripletBlock<I> block(triplets);
+			vector<I> sums(n);
+			vector<float> px(n), py(n), pz(n);
+
+			benchmark("sum() x1M, vector<Triplet>", 10, [&]() {
+				for(size_t i = 0; i < n; ++i) sums[i] = triplets[i].sum();
+			});
+			benchmark("sums() x1M, TripletBlock", 10, [&]() { block.sums(sums.data()); });
+			benchmark("project x1M, vector<Triplet>", 10, [&]() {
+				for(size_t i = 0; i < n; ++i) {
+					const Triplet<I> &p = triplets[i];
+					float sum = (float)p.sum();
+					px[i] = (float)p.x / sum;
+					py[i] = (float)p.y / sum;
+					pz[i] = (float)p.z / sum;
+				}
+			});
+			benchmark("project() x1M, TripletBlock", 10, [&]() { block.project(px.data(), py.data(), pz.data()); });
+		}
 
+		cout << "--- GCD of triplets: Euclid vs. binary vs. batched ---\n";
+		{
+			const size_t n = 1000000;
+			TripletBlock<I> block;
+			srand(1);
+			for(size_t i = 0; i < n; ++i) block.push_back(Triplet<I>(I(rand() % 10000 + 1), I(rand() % 10000 + 1), I(rand() % 10000 + 1)));
+			vector<I> g(n), expected(n);
+
+			benchmark("gcd(gcd(x, y), z) x1M, Euclid", 3, [&]() {
+				for(size_t i = 0; i < n; ++i) expected[i] = ::gcd(block.x()[i], ::gcd(block.y()[i], block.z()[i]));
+			});
+			benchmark("gcdBinary(x, y, z) x1M", 3, [&]() {
+				for(size_t i = 0; i < n; ++i) g[i] = gcdBinary(block.x()[i], block.y()[i], block.z()[i]);
+			});
+			assert(g == expected);
+			benchmark("gcds() x1M, TripletBlock", 3, [&]() { block.gcds(g.data()); });
+			assert(g == expected);
+		}
 
-		//if(!found)
+		cout << "--- Visited set: std::map vs. TripletHashSet ---\n";
+		for(int n = 100000; n <= 10000000; n *= 10)
 		{
-			if(depth >= m_maxDepth) 
-			{
-				++m_countMaxDepth;
-				m_bestPath = (triangle.path + "...");
-				return 0;
+			// distinct pseudo-random triplets; each is checked twice, as midpoints shared by neighbouring triangles are
+			vector<Triplet<I>> keys(n);
+			unsigned long long seed = 1;
+			for(auto &p : keys) {
+				seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+				p.set(I(seed >> 44), I((seed >> 24) & 0xfffff), I((seed >> 4) & 0xfffff) + 1);
 			}
 
-			/*
-			// build 6 subregions, characterize point: deprecate
-			TripletTriangle<I> mx('x', triangle); int inmx = mx.containsPoint(m_target);
-			TripletTriangle<I> my('y', triangle); int inmy = my.containsPoint(m_target);
-			TripletTriangle<I> mz('z', triangle); int inmz = mz.containsPoint(m_target);
-			TripletTriangle<I> mX('X', triangle); int inmX = mX.containsPoint(m_target);
-			TripletTriangle<I> mY('Y', triangle); int inmY = mY.containsPoint(m_target);
-			TripletTriangle<I> mZ('Z', triangle); int inmZ = mZ.containsPoint(m_target);
-			int regionCount = inmx + inmy + inmz + inmX + inmY + inmZ;
-			*/
+			size_t found = 0;
+			string name = "std::map, " + std::to_string(n) + " keys";
+			benchmark(name.c_str(), 1, [&]() {
+				std::map<Triplet<I>, string> map;
+				for(int pass = 0; pass < 2; ++pass) {
+					for(auto &p : keys) {
+						if(map.find(p) == map.end()) {
+							map[p] = string();
+						}
+					}
+				}
+				found = map.size();
+			});
+
+			size_t hashed = 0;
+			name = "TripletHashSet, " + std::to_string(n) + " keys";
+			benchmark(name.c_str(), 1, [&]() {
+				TripletHashSet<I> set;
+				for(int pass = 0; pass < 2; ++pass) {
+					for(auto &p : keys) {
+						set.insert(p);
+					}
+				}
+				hashed = set.size();
+			});
+			assert(found == hashed);
+		}
 
-			/*
-			//	METHOD ONE
-			// note that mirror symmetry is broken here, to avoid duplicate paths to edge points:
-			// points on edges (other than the centroid) are resolved to neighboring regions in a
-			// counterclockwise fashion.
-			// points on the X median nearer to X, for example, are resolved 
-			// as if the edge is part of the X- region;
-			// points on the X median nearer the YZ edge are resolved as if in the Z+ region.
-			// This breaks mirror symmetry but preserves a sort of rotational symmetry.
-			// Not sure how else this could be resolved: 
-			// - accept that there would be up to 2 paths to a triplet?
-			// - on reaching a median, collapse to 2 points--exclude one of the other vertices 
-			//   from all further calculations. this reduces to a modified rational tree traversal.
+		cerr.rdbuf(cerrbuf);
+	}
 
-			if(sextant == SEXX0 || sextant == SEXXN)
-			{
-				foundCount += searchR(TripletTriangle<I>('x', triangle), path + 'x', depth + 1);
+private:
+	//	sum of the centroids' x over the sextant tree below tri, applying ops through the op switch,
+	//	or through compiled when given
+	static long long sumTree(const TripletTriangle<I> &tri, int depth, const vector<typename TripletOpTable<I>::CompiledOp> *compiled)
+	{
+		long long sum = tri.centroid().x;
+		if(!depth) return sum;
+		TripletTriangle<I> child;
+		for(int i = 0; i < 6; ++i) {
+			child.set(tri[0], tri[1], tri[2]);
+			if(compiled) (*compiled)[i].apply(child);
+			else child.apply("xyzXYZ"[i]);
+			sum += sumTree(child, depth - 1, compiled);
+		}
+		return sum;
+	}
+
+	//	cost of the same search and leftOf() work in coordinate type W
+	template<class W>
+	static void benchmarkWidth(const char *label)
+	{
+		TripletSearch<W> s;
+		s.m_bVerbose = false;
+		s.m_maxDepth = 1050;
+		string name = string("search x1000 depth 1050, ") + label;
+		benchmark(name.c_str(), 3, [&]() {
+			for(int i = 1; i <= 1000; ++i) {
+				s.search(Triplet<W>(1000, i, 1000 - i + 1));
 			}
-			else if(sextant == SEXXY || sextant == SEXYP)
-			{
-				foundCount += searchR(TripletTriangle<I>('Y', triangle), path + 'Y', depth + 1);
+		});
+
+		vector<Triplet<W>> pts(1024);
+		srand(1);
+		for(auto &p : pts) {
+			p.set(W(rand() % 10000), W(rand() % 10000), W(rand() % 10000) + 1);
+		}
+		int sum = 0;
+		name = string("leftOf x10M, ") + label;
+		benchmark(name.c_str(), 1, [&]() {
+			for(int i = 0; i < 10000000; ++i) {
+				sum += leftOf(pts[i & 1023], pts[(i + 1) & 1023], pts[(i >> 10) & 1023]);
 			}
-			else if(sextant == SEXY0 || sextant == SEXYN)
-			{
-				foundCount += searchR(TripletTriangle<I>('y', triangle), path + 'y', depth + 1);
+		});
+		printf("  %-40s %10d\n", "leftOf checksum", sum);
+	}
+
+	//	single-width leftOfIn() (the former leftOf()), leftOfExact() and the adaptive leftOf(), on
+	//	small random triples, large random triples, and large near-collinear triples (c = a + b,
+	//	half of them nudged off the line) where the double filter falls back to exact arithmetic
+	template<class W>
+	static void benchmarkLeftOf(const char *label)
+	{
+		typedef typename Wide<W>::type WW;
+		const int n = 1024;
+		vector<Triplet<W>> pts[3];
+		srand(1);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < 3; ++j) {
+				pts[0].push_back(Triplet<W>(W(rand() % 10000), W(rand() % 10000), W(rand() % 10000) + 1));
+				W big[3];
+				for(int k = 0; k < 3; ++k) big[k] = W(((rand() & 0x7fff) << 14) | (rand() & 0x3fff)) + 1;
+				pts[1].push_back(Triplet<W>(big[0], big[1], big[2]));
 			}
-			else if(sextant == SEXYZ || sextant == SEXZP)
-			{
-				foundCount += searchR(TripletTriangle<I>('Z', triangle), path + 'Z', depth + 1);
+			Triplet<W> a = pts[1][3 * i], b = pts[1][3 * i + 1];
+			Triplet<W> c = a + b;
+			if(i & 1) c.x += 1;
+			pts[2].push_back(a);
+			pts[2].push_back(b);
+			pts[2].push_back(c);
+		}
+
+		const char *kinds[3] = { "small", "large", "large collinear" };
+		for(int set = 0; set < 3; ++set) {
+			int sums[3] = { 0, 0, 0 };
+			for(int method = 0; method < 3; ++method) {
+				static const char *methods[3] = { "single-width", "exact", "adaptive" };
+				string name = string("leftOf x10M, ") + kinds[set] + ", " + methods[method] + ", " + label;
+				benchmark(name.c_str(), 1, [&]() {
+					for(int i = 0; i < 10000000; ++i) {
+						const Triplet<W> *p = &pts[set][3 * (i & (n - 1))];
+						sums[method] += method == 0 ? leftOfIn<WW>(p[0], p[1], p[2])
+							: method == 1 ? leftOfExact(p[0], p[1], p[2])
+							: leftOf(p[0], p[1], p[2]);
+					}
+				});
 			}
-			else if(sextant == SEXZ0 || sextant == SEXZN)
-			{
-				foundCount += searchR(TripletTriangle<I>('z', triangle), path + 'z', depth + 1);
+			printf("  %-40s %10d %d %d\n", "checksums", sums[0], sums[1], sums[2]);
+		}
+	}
+};		// class TripletSearch
+
+
+//
+//	Multi-process sharded enumeration
+//	The 6^m_splitDepth subtrees at the split depth are cut into m_numShards contiguous shards, which
+//	are dealt out in contiguous runs to m_numWorkers worker processes. Each worker runs the sharded
+//	enumerate() one shard at a time and writes the shard's rows, sorted by Triplet, to its own file.
+//	The file is written under a temporary name and renamed once complete, so it either holds the
+//	whole shard or doesn't exist. A worker that fails is relaunched up to m_maxRestarts times, and
+//	skips the shards already written. run() deletes the shard files first, so only shards of the
+//	same run are skipped, never those left by an earlier one.
+//
+//	The shard files are then k-way merged. Each triplet keeps its row from the lowest shard, which
+//	is the serial enumerate()'s row, so the output matches enumerate() and dumpEnumerationResults().
+//	Memory is bounded by one shard per worker, and one row per shard during the merge.
+//
+template<class I>
+class ShardedEnumeration
+{
+public:
+	// runs one worker with the given arguments, "<first shard> <last shard>", and waits for it;
+	// returns its exit status. The default runs m_command with the arguments appended.
+	// the worker is expected to call work() on shards [first, last)
+	typedef std::function<int(const string &args)> Launcher;
+
+	string m_command;
+	Launcher m_launch;
+	string m_prefix = "enumeration";		// shard files: <prefix>.<shard>
+	unsigned int m_splitDepth = 4;
+	unsigned int m_numShards = 64;
+	unsigned int m_numWorkers = 0;			// 0: one per core
+	unsigned int m_maxRestarts = 3;
+
+	string shardFile(unsigned int shard) const {
+		return m_prefix + "." + std::to_string(shard);
+	}
+
+	// first subtree of shard, as numbered by TripletPath::rank() at the split depth
+	unsigned long long shardBegin(unsigned int shard) const {
+		return TripletPath::rankCount(m_splitDepth) * shard / m_numShards;
+	}
+
+	bool isWritten(unsigned int shard) const {
+		return std::ifstream(shardFile(shard)).good();
+	}
+
+	// driver: runs the workers, then merges their shards into out.
+	// returns false if a worker still fails after its restarts
+	bool run(ostream &out, size_t *pCount = nullptr) {
+		assert(m_numShards > 0 && m_numShards <= TripletPath::rankCount(m_splitDepth));
+
+		unsigned int numWorkers = m_numWorkers ? m_numWorkers : (std::max)(1u, std::thread::hardware_concurrency());
+		numWorkers = (std::min)(numWorkers, m_numShards);
+		Launcher launch = m_launch ? m_launch : [this](const string &args) {
+#ifdef _WIN32
+			// cmd /c strips the first and last quotes of a line with more than one quoted argument
+			return ::system(("\"" + m_command + " " + args + "\"").c_str());
+#else
+			return ::system((m_command + " " + args).c_str());
+#endif
+		};
+
+		// shards left by another run, maybe with other limits, must not pass for this run's
+		clear();
+
+		vector<unsigned int> attempts(numWorkers, 0);
+		vector<char> done(numWorkers, 0);
+		vector<std::thread> threads;
+		for(unsigned int w = 0; w < numWorkers; ++w) {
+			threads.emplace_back([&, w]() {
+				unsigned int first = m_numShards * w / numWorkers;
+				unsigned int last = m_numShards * (w + 1) / numWorkers;
+				string args = std::to_string(first) + " " + std::to_string(last);
+				while(!done[w] && attempts[w] <= m_maxRestarts) {
+					++attempts[w];
+					int status = launch(args);
+					done[w] = (status == 0);
+					for(unsigned int shard = first; done[w] && shard < last; ++shard) {
+						done[w] = isWritten(shard);
+					}
+				}
+			});
+		}
+		for(auto &thread : threads) {
+			thread.join();
+		}
+
+		bool bDone = true;
+		for(unsigned int w = 0; w < numWorkers; ++w) {
+			unsigned int first = m_numShards * w / numWorkers;
+			unsigned int last = m_numShards * (w + 1) / numWorkers;
+			if(attempts[w] > 1) {
+				cerr << "Worker for shards [" << first << ", " << last << ") ran " << attempts[w] << " times"
+					<< (done[w] ? "\n" : " and failed\n");
 			}
-			else if(sextant == SEXZX || sextant == SEXXP)
-			{
-				foundCount += searchR(TripletTriangle<I>('X', triangle), path + 'X', depth + 1);
+			bDone = bDone && done[w];
+		}
+		return bDone && merge(out, pCount);
+	}
+
+	// worker: enumerates shards [first, last) with search's limits, skipping those already written.
+	// the result limit applies per shard
+	bool work(TripletSearch<I> &search, unsigned int first, unsigned int last) const {
+		for(unsigned int shard = first; shard < last; ++shard) {
+			if(isWritten(shard)) {
+				continue;
 			}
-			else
+
+			search.enumerate(m_splitDepth, shardBegin(shard), shardBegin(shard + 1));
+			string file = shardFile(shard);
+			string temp = file + ".tmp";
 			{
-				cerr << "!!??\n";
+				std::ofstream stream(temp);
+				for(auto &entry : search.m_enumeration) {
+					stream << entry.second << '\n';
+				}
+				if(!stream.flush()) {
+					return false;
+				}
 			}
-			//*/
+			::remove(file.c_str());
+			if(::rename(temp.c_str(), file.c_str())) {
+				return false;
+			}
+		}
+		return true;
+	}
 
-			//	METHOD TWO
+	// k-way merge of the shard files into out, in Triplet order, keeping each triplet's lowest shard row
+	bool merge(ostream &out, size_t *pCount = nullptr) const {
+		// priority_queue keeps the greatest on top, so this orders on the smallest triplet, then the lowest shard
+		struct Head
+		{
+			Triplet<I> p;
+			unsigned int shard;
 
+			bool operator < (const Head &rhs) const {
+				if(rhs.p < p) return true;
+				if(p < rhs.p) return false;
+				return shard > rhs.shard;
+			}
+		};
+
+		vector<std::ifstream> streams(m_numShards);
+		vector<string> lines(m_numShards);
+		std::priority_queue<Head> heads;
+		auto advance = [&](unsigned int shard) {
+			if(std::getline(streams[shard], lines[shard])) {
+				Head head;
+				std::istringstream(lines[shard]) >> head.p;
+				head.shard = shard;
+				heads.push(head);
+			}
+		};
 
-            //  2D
-            if (triangle.numColumns() == 2)
-            {
-                // 3 possibilities: x-ward, y-ward, or 0 (target found)
-                if (sextant == SEXX0) 	// on line between X and ctr
-                    foundCount += searchR(triangle + 'r', depth + 1);
-                else if (sextant == SEXY0)	// on line between Y and ctr
-                    foundCount += searchR(triangle + 'l', depth + 1);
-                else if (sextant == SEX00)
-                    foundCount += searchR(triangle + '1', depth + 1);
-                else
-                    throw(std::exception("Invalid 2D sextant result"));
-                return foundCount;
-            }
+		for(unsigned int shard = 0; shard < m_numShards; ++shard) {
+			streams[shard].open(shardFile(shard));
+			if(!streams[shard]) {
+				cerr << "Missing shard: " << shardFile(shard) << endl;
+				return false;
+			}
+			advance(shard);
+		}
 
-            // 3 column
-            if (sextant == SEX00)
-            {
-                m_paths.push_back(triangle.path + "-ctr");
-                return 1;
-            }
-            else if(sextant == SEXXN)
-				foundCount += searchR( triangle + 'x', depth + 1);
-			else if(sextant == SEXYP)
-				foundCount += searchR( triangle + 'Y', depth + 1);
-			else if(sextant == SEXYN)
-				foundCount += searchR( triangle + 'y', depth + 1);
-			else if(sextant == SEXZP)
-				foundCount += searchR( triangle + 'Z', depth + 1);
-			else if(sextant == SEXZN)
-				foundCount += searchR( triangle + 'z', depth + 1);
-			else if(sextant == SEXXP)
-				foundCount += searchR( triangle + 'X', depth + 1);
-			else if(sextant == SEXX0) 	// on line between X and ctr: merge YZ, then toward X
-				foundCount += searchR( triangle + '2', depth + 1);
-			else if(sextant == SEXYZ) 	// on line between ctr and YZ's midpoint: merge YZ, then toward Y
-				foundCount += searchR( triangle + '2', depth + 1);
-			else if(sextant == SEXY0)	// on line between Y and ctr: merge XZ->X, then toward Y
-				foundCount += searchR( triangle + '3', depth + 1);
-			else if(sextant == SEXZX)	// on line between ctr and XZ's midpoint: merge XZ->X, then toward X
-				foundCount += searchR( triangle + '3', depth + 1);
-			else if(sextant == SEXZ0)	// on line between Z and ctr: merge XY->X, then toward Y (formerly Z)
-				foundCount += searchR( triangle + '1', depth + 1);
-			else if(sextant == SEXXY)	// on line between ctr and XY's midpoint: merge XY->X, then toward X
-				foundCount += searchR( triangle + '1', depth + 1);
-			else
-			{
-				cerr << "!!??\n";
+		size_t count = 0;
+		Triplet<I> last;
+		while(!heads.empty()) {
+			Head head = heads.top();
+			heads.pop();
+			if(!count || last < head.p) {
+				out << lines[head.shard] << '\n';
+				last = head.p;
+				++count;
 			}
+			advance(head.shard);
 		}
 
-		//if(foundCount && m_bVerbose) {
-		//	cout << "** found in " << path << " **\n" << triangle;
-		//}
+		if(pCount) *pCount = count;
+		return true;
+	}
 
-		return foundCount;
+	// deletes the shard files, and any left half written
+	void clear() const {
+		for(unsigned int shard = 0; shard < m_numShards; ++shard) {
+			::remove(shardFile(shard).c_str());
+			::remove((shardFile(shard) + ".tmp").c_str());
+		}
 	}
+};
 
-public:
 
-	void dumpSearchResults() const {
-		if(m_paths.size() == 1) {
-			cout << "Path to " << m_target << ": " << m_paths[0] << endl;
+//
+//	Read-only memory-mapped file
+//
+class MappedFile
+{
+public:
+	MappedFile() {}
+	MappedFile(const MappedFile &) = delete;
+	MappedFile& operator=(const MappedFile &) = delete;
+	~MappedFile() { close(); }
+
+	const unsigned char *data() const { return m_data; }
+	size_t size() const { return m_size; }
+
+	bool open(const string &file) {
+		close();
+#ifdef _WIN32
+		m_file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		LARGE_INTEGER size;
+		if(m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || !size.QuadPart) {
+			close();
+			return false;
 		}
-		else if(m_paths.size() > 1) {
-			cout << " MULTIPLE PATHS!!" << endl;
-			for(unsigned int i = 0; i < m_paths.size(); ++i) {
-				cout << m_paths[i] << ", ";
-			}
-			cout << endl;
+		m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+		m_data = m_mapping ? (const unsigned char *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		m_size = (size_t)size.QuadPart;
+#else
+		int fd = ::open(file.c_str(), O_RDONLY);
+		struct stat info;
+		if(fd < 0 || fstat(fd, &info) || !info.st_size) {
+			if(fd >= 0) ::close(fd);
+			return false;
 		}
-		else {
-			cout << m_target << ": **** NO PATHS FOUND at depth " << m_maxDepth << " ****\n";
+		void *data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		m_data = (data == MAP_FAILED) ? nullptr : (const unsigned char *)data;
+		m_size = (size_t)info.st_size;
+#endif
+		if(!m_data) {
+			close();
+			return false;
 		}
+		return true;
 	}
 
-	//
-	//	Traversal / Enumeration
-	//
-
-	bool enumerate() {
-
-		assert(m_maxDepth >= 0 && m_maxDepth < 1000);
-		assert(m_maxHeight > 1);
-		//assert(m_clip.isCoprime());
-		assert(m_clip.isTriangle());
-
-		cerr << "Enumerating depth: " << m_maxDepth << " max height: " << m_maxHeight
-			<< " max results: " << m_maxNumEnumerationResults
-			<< "\nClip triangle:\n" << m_clip;
-
-		m_enumeration.clear();
-		m_countMaxDepth = 0;
-		m_countMaxHeight = 0;
-		m_countDeadEnds = 0;
-		TripletTriangle<I> m;
+	void close() {
+#ifdef _WIN32
+		if(m_data) UnmapViewOfFile(m_data);
+		if(m_mapping) CloseHandle(m_mapping);
+		if(m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+		m_mapping = NULL;
+		m_file = INVALID_HANDLE_VALUE;
+#else
+		if(m_data) munmap((void *)m_data, m_size);
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
 
-		// enumerate the 3 parent vertices
-		enumerateCheck(m[0], "-P0", 0);
-		enumerateCheck(m[1], "-P1", 0);
-		enumerateCheck(m[2], "-P2", 0);
+private:
+#ifdef _WIN32
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = NULL;
+#endif
+	const unsigned char *m_data = nullptr;
+	size_t m_size = 0;
+};
 
-		// recursively enumerate all descendent vertices
-		enumerateR(m, "", 0);
 
-		return true;
+//
+//	Binary enumeration file
+//	The enumeration results in Triplet order, as dumpEnumerationResults() lists them, in sections
+//	after a header, each section 8-byte aligned:
+//		triplets	count Triplet<I>, fixed width
+//		offsets		count + 1 path offsets, 64 bits, in bytes from the start of the paths section
+//		depths		count depths, 32 bits
+//		codes		count suffix indices, 8 bits; the high bit is set for a path of an odd number of nibbles
+//		paths		the TripletPath nibble forms, each starting on a byte
+//	The reader maps the file and reads it in place: a lookup is a binary search on the triplets,
+//	and a scan reads the sections front to back, with nothing to parse.
+//
+template<class I>
+class EnumerationFile
+{
+public:
+	struct Header
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned int tripletBytes;		// sizeof(Triplet<I>)
+		unsigned int maxDepth;
+		unsigned int maxHeight;
+		unsigned int reserved;
+		unsigned long long count;
+		unsigned long long pathBytes;
+	};
+
+	static const unsigned int MAGIC = 0x4e455545;		// "EUEN"
+	static const unsigned int VERSION = 2;
+
+	struct Record
+	{
+		Triplet<I> p;
+		TripletPath path;
+		const char *suffix;
+		unsigned int depth;
+
+		bool operator < (const Record &rhs) const { return p < rhs.p; }
+	};
+
+	// runs search's enumerate() and writes its results to file
+	static bool write(const string &file, TripletSearch<I> &search) {
+		vector<Record> records;
+		search.enumerate([&](const Triplet<I> &p, const TripletPath &path, const char *suffix, unsigned int depth) {
+			records.push_back(Record{ p, path, suffix, depth });
+		});
+		return write(file, records, search.m_maxDepth, search.m_maxHeight);
 	}
 
-	void dumpEnumerationResults() const {
-		for(auto i = m_enumeration.begin(); i != m_enumeration.end(); ++i) {
-			// key is the triplet, "[1,2,3]"
-			//cout << "\"" << i->first << "\",";
-			cout << i->second << endl;
+	// writes records, which must be unique, sorting them first
+	static bool write(const string &file, vector<Record> &records, unsigned int maxDepth, unsigned int maxHeight) {
+		static_assert(sizeof(Triplet<I>) == 3 * sizeof(I), "Triplet<I> must be packed");
+		std::sort(records.begin(), records.end());
+
+		Header header = { MAGIC, VERSION, (unsigned int)sizeof(Triplet<I>), maxDepth, maxHeight, 0, records.size(), 0 };
+		vector<unsigned long long> offsets;
+		offsets.reserve(records.size() + 1);
+		for(auto &record : records) {
+			offsets.push_back(header.pathBytes);
+			header.pathBytes += record.path.bytes();
 		}
-
-		cerr << "Enumerated " << m_enumeration.size() << " unique triplets.\n";
-		cerr << "Max depth: " << m_countMaxDepth << " Max height: " << m_countMaxHeight << endl;
-
-		for(auto i = m_depthCounts.begin(); i != m_depthCounts.end(); ++i) {
-			cerr << "Depth " << i->first << ": " << i->second << endl;
+		offsets.push_back(header.pathBytes);
+
+		std::ofstream out(file, std::ios::binary | std::ios::trunc);
+		const char zeros[8] = { 0 };
+		auto pad = [&]() { out.write(zeros, (size_t)((8 - (unsigned long long)out.tellp() % 8) % 8)); };
+		out.write((const char *)&header, sizeof(header));
+		for(auto &record : records) {
+			out.write((const char *)&record.p, sizeof(Triplet<I>));
+		}
+		pad();
+		out.write((const char *)offsets.data(), offsets.size() * sizeof(offsets[0]));
+		for(auto &record : records) {
+			out.write((const char *)&record.depth, sizeof(record.depth));
+		}
+		pad();
+		for(auto &record : records) {
+			char code = (char)(TripletSearch<I>::enumerationSuffixCode(record.suffix) | ((record.path.nibbles() & 1) << 7));
+			out.write(&code, 1);
 		}
+		pad();
+		for(auto &record : records) {
+			out.write((const char *)record.path.data(), record.path.bytes());
+		}
+		return !!out.flush();
 	}
 
-private:
-
-	bool enumerateCheck(const Triplet<I> &p, string path, unsigned int depth) {
-		if(abs(p.sum()) > m_maxHeight) {
+	bool open(const string &file) {
+		if(!m_file.open(file) || m_file.size() < sizeof(Header)) {
+			close();
 			return false;
 		}
-
-		if(m_enumeration.size() >= m_maxNumEnumerationResults) {
+		m_header = (const Header *)m_file.data();
+		if(m_header->magic != MAGIC || m_header->version != VERSION || m_header->tripletBytes != sizeof(Triplet<I>)) {
+			close();
 			return false;
 		}
 
-		if(!m_clip.containsPoint(p)) {
+		size_t count = (size_t)m_header->count;
+		const unsigned char *p = m_file.data() + sizeof(Header);
+		m_triplets = (const Triplet<I> *)p;
+		p += align(count * sizeof(Triplet<I>));
+		m_offsets = (const unsigned long long *)p;
+		p += (count + 1) * sizeof(unsigned long long);
+		m_depths = (const unsigned int *)p;
+		p += align(count * sizeof(unsigned int));
+		m_codes = p;
+		p += align(count);
+		m_paths = p;
+		if((size_t)(p - m_file.data()) + m_header->pathBytes != m_file.size()) {
+			close();
 			return false;
 		}
+		return true;
+	}
 
-		if(m_enumeration.find(p) == m_enumeration.end()) {
-			// add CSV fields: x,y,z,path
-			stringstream str;
-			str << p.x << "," << p.y << "," << p.z << ",\"" << path << "\"," << depth;
-			m_enumeration[p] = str.str();
-			return true;
-		}
-
-		return false;
+	void close() {
+		m_file.close();
+		m_header = nullptr;
 	}
 
-	std::map<unsigned int, unsigned int> m_depthCounts;
+	size_t size() const { return m_header ? (size_t)m_header->count : 0; }
+	unsigned int maxDepth() const { return m_header ? m_header->maxDepth : 0; }
+	unsigned int maxHeight() const { return m_header ? m_header->maxHeight : 0; }
 
-	void enumerateR(const TripletTriangle<I> &triangle, string path, unsigned int depth) {
+	const Triplet<I> &triplet(size_t i) const { return m_triplets[i]; }
+	unsigned int depth(size_t i) const { return m_depths[i]; }
+	const char *suffix(size_t i) const { return TripletSearch<I>::enumerationSuffix(m_codes[i] & 0x7f); }
 
-		if(depth > m_maxDepth) {
-			++m_countMaxDepth;
-			return;
-		}
+	TripletPath path(size_t i) const {
+		TripletPath path;
+		unsigned int nibbles = (unsigned int)(2 * (m_offsets[i + 1] - m_offsets[i])) - (m_codes[i] >> 7);
+		path.assign(m_paths + m_offsets[i], nibbles);
+		return path;
+	}
 
-		if(m_enumeration.size() >= m_maxNumEnumerationResults) {
-			//cerr << ".. max results reached: " << m_enumeration.size() << " ..";
-			return;
-		}
+	// index of p, or size() if it isn't in the file
+	size_t find(const Triplet<I> &p) const {
+		const Triplet<I> *end = m_triplets + size();
+		const Triplet<I> *found = std::lower_bound(m_triplets, end, p);
+		return (found != end && !(p < *found)) ? (size_t)(found - m_triplets) : size();
+	}
 
-		if(!trianglesIntersect(triangle, m_clip)) {
-			return;
+	bool lookup(const Triplet<I> &p, TripletPath &path) const {
+		size_t i = find(p);
+		if(i == size()) {
+			return false;
 		}
+		path = this->path(i);
+		return true;
+	}
 
-		cerr << "Intersection: depth=" << depth << endl << triangle;
-		++m_depthCounts[depth];
-
-		// compute the triangle edge midpoints and centroid
-		Triplet<I> p01 = triangle[0] + triangle[1];
-		Triplet<I> p12 = triangle[1] + triangle[2];
-		Triplet<I> p02 = triangle[0] + triangle[2];
-		Triplet<I> ctr = triangle.centroid();
-		assert(ctr.isCoprime());
-
-		enumerateCheck(p01, path + "-p01", depth);
-		enumerateCheck(p12, path + "-p12", depth);
-		enumerateCheck(p02, path + "-p02", depth);
-		enumerateCheck(ctr, path + "-ctr", depth);
+	// the CSV row of entry i, as dumpEnumerationResults() writes it
+	void writeRow(ostream &out, size_t i) const {
+		TripletSearch<I>::writeEnumerationRow(out, triplet(i), path(i), suffix(i), depth(i));
+	}
 
-		if(abs(ctr.sum()) > m_maxHeight) {
-			++m_countMaxHeight;
-			return;
+	// calls f(p, path, suffix, depth) for each entry in order
+	template<class F>
+	void forEach(F f) const {
+		for(size_t i = 0; i < size(); ++i) {
+			f(triplet(i), path(i), suffix(i), depth(i));
 		}
-
-		enumerateR(TripletTriangle<I>('x', triangle), path + 'x', depth + 1);
-		enumerateR(TripletTriangle<I>('y', triangle), path + 'y', depth + 1);
-		enumerateR(TripletTriangle<I>('z', triangle), path + 'z', depth + 1);
-		enumerateR(TripletTriangle<I>('X', triangle), path + 'X', depth + 1);
-		enumerateR(TripletTriangle<I>('Y', triangle), path + 'Y', depth + 1);
-		enumerateR(TripletTriangle<I>('Z', triangle), path + 'Z', depth + 1);
-
 	}
 
-	public:
-
-	static int runTests() 
-	{
-		// GCD algs
-		{
-			int nn[12] = { 16, 16, 16, 27, 27, 9, 0, 0, 0, 8, 8, 8 };
-			assert(::gcd(nn, 12) == 1);
-			int mm[12] = { 48, 15, 12, 27, 27, 9, 0, 0, 0, 90, 24, 21 };
-			assert(::gcd(mm, 12) == 3);
-
-			assert(::gcd(8, 1) == 1);
-			assert(::gcd(0, 1) == 1);
-			assert(::gcd(0, 8) == 8);
-			assert(::gcd(40, 32) == 8);
-			assert(::gcd(0, 0) == 0);
-
-			int n[3] = { 8, 8, 8 };
-			assert(::gcd(n, 3) == 8);
-			n[2] = 5;
-			assert(::gcd(n, 3) == 1);
-			n[2] = 0;
-			assert(::gcd(n, 3) == 8);
-			n[1] = 0;
-			assert(::gcd(n, 3) == 8);
-			n[0] = 0;
-			assert(::gcd(n, 3) == 0);
-		}
+private:
+	MappedFile m_file;
+	const Header *m_header = nullptr;
+	const Triplet<I> *m_triplets = nullptr;
+	const unsigned long long *m_offsets = nullptr;
+	const unsigned int *m_depths = nullptr;
+	const unsigned char *m_codes = nullptr;
+	const unsigned char *m_paths = nullptr;
+
+	static size_t align(size_t bytes) { return (bytes + 7) & ~(size_t)7; }
+};
 
-		// triangle algs
 
-		TripletTriangle<int> tri;
+//
+//	Precomputed path table
+//	search()'s path for every positive coprime triplet up to a height, for O(1) lookup.
+//	The triplets of height h, x + y + z == h, are ranked by x then y, after the C(h - 1, 3) positive
+//	triplets below h, so the table is a dense array of C(H, 3) entries, one per positive triplet up
+//	to height H. An entry is the byte offset of the triplet's path in the path blob that follows the
+//	table, or EMPTY for a triplet that isn't coprime. A blob record is:
+//		ops			16 bits, the path's op count, to check against m_maxDepth
+//		nibbles		16 bits
+//		terminal	8-bit length, then the chars search() appends after the ops, such as "!"
+//		path		the packed TripletPath
+//	The file is memory-mapped, so opening it costs nothing, and a lookup reads one table entry
+//	and one record. The paths come from searchBatch(), which finds the same paths as search().
+//
+template<class I>
+class PathTable
+{
+public:
+	struct Header
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned int maxHeight;
+		unsigned int reserved;
+		unsigned long long count;		// table entries
+		unsigned long long blobBytes;
+	};
+
+	static const unsigned int MAGIC = 0x54505545;		// "EUPT"
+	static const unsigned int VERSION = 1;
+	static const unsigned int EMPTY = 0xffffffff;
+
+	// number of positive triplets up to height: C(height, 3)
+	static unsigned long long tableSize(unsigned long long height) {
+		return (height < 3) ? 0 : height * (height - 1) * (height - 2) / 6;
+	}
 
-		for(int i = 0; i < 1000; ++i) {
-			tri = TripletTriangle<int>();
-			for(int j = 0; j < 20; ++j) {
-				int c = rand() % 3;
-				int d = (c + 1 + rand() % 2) % 3;
-				tri.merge(c, d);
-				assert(tri.isCoprime());
-				tri = tri.transpose();
-				c = rand() % 3;
-				d = (c + 1 + rand() % 2) % 3;
-				tri.merge(c, d);
-				assert(tri.isCoprime());
-			}
-		}
+	// index of positive triplet p among those up to its height. the height is summed in 64 bits,
+	// as p.sum() can overflow I
+	static unsigned long long rank(const Triplet<I> &p) {
+		unsigned long long x = (unsigned long long)p.x, y = (unsigned long long)p.y;
+		unsigned long long h = x + y + (unsigned long long)p.z;
+		return tableSize(h - 1) + (x - 1) * (h - 1) - x * (x - 1) / 2 + (y - 1);
+	}
 
-		// math: any matrix with det == 1 is coprime? (yes--all rows and columns)
-		// however the converse is not true
-		for(int count = 0; count < 100; ) {
-			for(int i = 0; i < 3; ++i) {
-				tri[i].x = rand() % 17;
-				tri[i].y = rand() % 16;
-				tri[i].z = rand() % 20;
-				if(tri.determinant() == 1) {
-					stringstream str;
-					str << tri << " iscoprime: " << tri.isCoprime() << endl;
-					TRACE(str.str().c_str());
-					assert(tri.isCoprime());
-					assert(tri.transpose().isCoprime());
-					++count;
+	// searches every positive coprime triplet up to maxHeight, one batch per height, and writes the table
+	static bool build(const string &file, unsigned int maxHeight) {
+		std::ofstream out(file, std::ios::binary | std::ios::trunc);
+		string blobFile = file + ".blob";
+		std::ofstream blob(blobFile, std::ios::binary | std::ios::trunc);
+		Header header = { MAGIC, VERSION, maxHeight, 0, tableSize(maxHeight), 0 };
+		out.write((const char *)&header, sizeof(header));
+
+		TripletSearch<I> search;
+		search.m_bVerbose = false;
+		search.m_maxDepth = 2 * maxHeight;		// well past any path up to maxHeight; a target not found is left EMPTY
+		vector<Triplet<I>> targets;
+		vector<unsigned int> entries;
+		for(unsigned int h = 3; h <= maxHeight; ++h) {
+			targets.clear();
+			entries.assign(tableSize(h) - tableSize(h - 1), (unsigned int)EMPTY);
+			for(unsigned int x = 1; x + 2 <= h; ++x) {
+				for(unsigned int y = 1; x + y + 1 <= h; ++y) {
+					Triplet<I> p(I(x), I(y), I(h - x - y));
+					if(gcdBinary(p.x, p.y, p.z) == 1) targets.push_back(p);
 				}
 			}
-		}
-
-		TripletTriangle<I> mBase;
-		assert(mBase.isCoprime());
-		assert(mBase.isTriangle());
-		assert(leftOf(mBase[0], mBase[1], mBase[2]));
-
-		TripletTriangle<I> mTest1(vec3(15, 10, 8), vec3(6, 4, 3), vec3(25, 17, 14));
-		TripletTriangle<I> mTest2(vec3(15, 10, 8), vec3(21, 14, 11), vec3(46, 31, 25));
-		bool bb;
-
-		cout << "Test 1\n" << mTest1;
-		assert(mTest1.isCoprime());
-		assert(mTest1.isTriangle());
-		bb = mTest1.containsPoint(vec3(36, 24, 19));
-		assert(bb);
-
-		cout << "Test 2\n" << mTest2;
-		assert(mTest2.isCoprime());
-		assert(mTest2.isTriangle());
-		bb = mTest2.containsPoint(vec3(36, 24, 19));
-		assert(bb);
-
-		int signabc;
-		vec3 a(1, 1, 1), b(3, 1, 2), c(3, 2, 1), temp;
-		signabc = leftOf(a, b, c);
-		assert(signabc == 1);
-		cout << "leftof(" << a << " , " << b << " , " << c << " ): " << signabc << endl;
-		temp = a; a = b; b = temp;
-		signabc = leftOf(a, b, c);
-		assert(signabc == -1);
-		cout << "leftof(" << a << " , " << b << " , " << c << " ): " << signabc << endl;
-		a.set(1, 0, 0); b.set(0, 1, 0); c.set(0, 0, 1);
-		signabc = leftOf(a, b, c);
-		assert(signabc == 1);
-		cout << "leftof(" << a << " , " << b << " , " << c << " ): " << signabc << endl;
-		// collinear test
-		a.set(3, 3, 4); b.set(3, 4, 6); c.set(3, 5, 8);
-		signabc = leftOf(a, b, c);
-		assert(signabc == 0);
-		cout << "leftof(" << a << " , " << b << " , " << c << " ): " << signabc << endl;
-
-		TripletSearch<int> s;
-		s.m_growth = GrowthEnum::POINT_SEARCH;
-		s.m_bVerbose = false;
-        s.m_maxDepth = 5;
-		TripletTriangle<I> t;
-		for(int i = 1; i <= 5; ++i) 
-		{
-			for(int j = 1; j <= i; ++j) 
-			{
-				for(int k = 1; k <= j; ++k) 
-				{
-					vec3 pt(i, j, k);
-					if(pt.isCoprime()) 
-					{
-						SexClass sex = t.getSextant(pt);
-						cout << pt << " Sex: " << sex.asChar;
-
-						s.search(pt);
-						cout << " search: " << s.m_paths.size() << " paths";
 
-						assert(s.m_paths.size() == 1);
-                        cout << " " << s.m_paths[0] << endl;
+			search.searchBatch(targets.data(), targets.size());
+			for(size_t i = 0; i < targets.size(); ++i) {
+				const string &found = search.m_batchPaths[i];
+				if(found.empty()) {
+					continue;
+				}
+				if(header.blobBytes >= EMPTY) {
+					cerr << "Path table " << file << " is over 4 GB\n";
+					return false;
+				}
+				entries[rank(targets[i]) - tableSize(h - 1)] = (unsigned int)header.blobBytes;
 
-						s.findAll(pt);
-						cout << " findAll: " << s.m_paths.size() << " paths found.\n";
-					}
+				// the ops, in display form, then the terminal
+				TripletPath path;
+				size_t end = 0;
+				while(end < found.size() && (TripletPath::opCode(found[end]) >= 0 || found[end] == '{')) {
+					end += (found[end] == '{') ? 4 : 1;
 				}
+				path.assign(found.substr(0, end));
+				string terminal = found.substr(end);
+				unsigned short ops = (unsigned short)path.size(), nibbles = (unsigned short)path.nibbles();
+				unsigned char length = (unsigned char)terminal.size();
+				blob.write((const char *)&ops, sizeof(ops));
+				blob.write((const char *)&nibbles, sizeof(nibbles));
+				blob.write((const char *)&length, sizeof(length));
+				blob.write(terminal.data(), length);
+				blob.write((const char *)path.data(), path.bytes());
+				header.blobBytes += sizeof(ops) + sizeof(nibbles) + sizeof(length) + length + path.bytes();
 			}
+			out.write((const char *)entries.data(), entries.size() * sizeof(entries[0]));
 		}
-		assert(t.getSextant(vec3(1, 1, 1)).asInt == *((int*)("000")));
-		assert(t.getSextant(vec3(1, 1, 2)).asInt == *((int*)("-+0")));
-		assert(t.getSextant(vec3(1, 1, 3)).asInt == *((int*)("-+0")));
-		assert(t.getSextant(vec3(1, 2, 1)).asInt == *((int*)("+0-")));
-		assert(t.getSextant(vec3(1, 2, 2)).asInt == *((int*)("0+-")));
-		assert(t.getSextant(vec3(1, 2, 3)).asInt == *((int*)("-+-")));
-		assert(t.getSextant(vec3(1, 3, 1)).asInt == *((int*)("+0-")));
-		assert(t.getSextant(vec3(1, 3, 2)).asInt == *((int*)("++-")));
-		assert(t.getSextant(vec3(1, 3, 3)).asInt == *((int*)("0+-")));
-		assert(t.getSextant(vec3(2, 1, 1)).asInt == *((int*)("0-+")));
-		assert(t.getSextant(vec3(2, 1, 2)).asInt == *((int*)("-0+")));
-		assert(t.getSextant(vec3(2, 1, 3)).asInt == *((int*)("-++")));
-		assert(t.getSextant(vec3(2, 2, 1)).asInt == *((int*)("+-0")));
-		assert(t.getSextant(vec3(2, 2, 3)).asInt == *((int*)("-+0")));
-		assert(t.getSextant(vec3(2, 3, 1)).asInt == *((int*)("+--")));
-		assert(t.getSextant(vec3(2, 3, 2)).asInt == *((int*)("+0-")));
-		assert(t.getSextant(vec3(2, 3, 3)).asInt == *((int*)("0+-")));
-		assert(t.getSextant(vec3(3, 1, 1)).asInt == *((int*)("0-+")));
-		assert(t.getSextant(vec3(3, 1, 2)).asInt == *((int*)("--+")));
-		assert(t.getSextant(vec3(3, 1, 3)).asInt == *((int*)("-0+")));
-		assert(t.getSextant(vec3(3, 2, 1)).asInt == *((int*)("+-+")));
-		assert(t.getSextant(vec3(3, 2, 2)).asInt == *((int*)("0-+")));
-		assert(t.getSextant(vec3(3, 2, 3)).asInt == *((int*)("-0+")));
-		assert(t.getSextant(vec3(3, 3, 1)).asInt == *((int*)("+-0")));
-		assert(t.getSextant(vec3(3, 3, 2)).asInt == *((int*)("+-0")));
 
-		// test 1: generate all coprime triples up to a limit, and ensure a unique path exists to each
+		// append the blob after the table
+		blob.close();
+		std::ifstream in(blobFile, std::ios::binary);
+		if(header.blobBytes) out << in.rdbuf();
+		in.close();
+		::remove(blobFile.c_str());
+		out.seekp(0);
+		out.write((const char *)&header, sizeof(header));
+		return !!out.flush();
+	}
 
-		std::priority_queue<vec3> q;
-		// fill queue with all coprime triples up to a limit
-		int n = 7;
-		for(int x = 1; x <= n; ++x) {
-			for(int y = 1; y <= n; ++y) {
-				for(int z = 1; z <= n; ++z) {
-					vec3 p = { x, y, z };
-					if(p.isCoprime()) {
-						// symmetry is established... restrict to one sextant
-						//if(p.x <= p.y && p.y <= p.z) 
-                        {
-							q.push(p);
-						}
-					}
-				}
-			}
+	bool open(const string &file) {
+		if(!m_file.open(file) || m_file.size() < sizeof(Header)) {
+			close();
+			return false;
 		}
+		m_header = (const Header *)m_file.data();
+		if(m_header->magic != MAGIC || m_header->version != VERSION || m_header->count != tableSize(m_header->maxHeight)
+			|| sizeof(Header) + m_header->count * sizeof(unsigned int) + m_header->blobBytes != m_file.size()) {
+			close();
+			return false;
+		}
+		m_table = (const unsigned int *)(m_file.data() + sizeof(Header));
+		m_blob = (const unsigned char *)(m_table + m_header->count);
+		return true;
+	}
 
+	void close() {
+		m_file.close();
+		m_header = nullptr;
+	}
 
-		while(q.size() > 0) {
-			vec3 p = q.top();
-			q.pop();
-			TripletSearch<int> search;
-			search.m_maxDepth = 8;
-			search.m_bVerbose = false;
-			//cout << "Searching for " << p << ": ";
-
-			search.search(p);
+	unsigned int maxHeight() const { return m_header ? m_header->maxHeight : 0; }
 
-			search.dumpSearchResults();
+	// search()'s path for p, and its op count. false if p is outside the table or search() doesn't find it
+	bool lookup(const Triplet<I> &p, string &path, unsigned int &ops) const {
+		// each coordinate is checked before they are added, so the sum can't overflow
+		const I height = I(maxHeight());
+		if(p.x < 1 || p.y < 1 || p.z < 1 || p.x > height || p.y > height || p.z > height
+			|| (unsigned long long)p.x + (unsigned long long)p.y + (unsigned long long)p.z > maxHeight()) {
+			return false;
 		}
-
-		cout << "Testing merge coprimality\n";
-
-		for(int i = 0; i < 100; ++i) {
-			TripletTriangle<I> x;
-			for(int j = 0; j < 50; ++j) {
-				int fromCol = rand() % 3;
-				int toCol = (fromCol + 1+rand() % 1) % 3;
-				x.merge(fromCol, toCol);
-				auto ctr = x.centroid();
-				int g = gcd(&ctr.x, 3);
-				ASSERT(ctr.isCoprime(), string("not coprime: ") +std::to_string(g)+" "+ std::to_string(x));
-			}
+		unsigned int offset = m_table[rank(p)];
+		if(offset == EMPTY) {
+			return false;
 		}
 
-		cout << "--- Completed tests ---\n>";
-		char dummy;
-		cin >> dummy;
-
-		return 1;
+		const unsigned char *record = m_blob + offset;
+		unsigned short nibbles;
+		memcpy(&nibbles, record + 2, sizeof(nibbles));
+		unsigned char length = record[4];
+		TripletPath packed;
+		packed.assign(record + 5 + length, nibbles);
+		path = packed.str();
+		path.append((const char *)record + 5, length);
+		unsigned short count;
+		memcpy(&count, record, sizeof(count));
+		ops = count;
+		return true;
 	}
-};		// class TripletSearch
+
+private:
+	MappedFile m_file;
+	const Header *m_header = nullptr;
+	const unsigned int *m_table = nullptr;
+	const unsigned char *m_blob = nullptr;
+};
 